@@ -0,0 +1,215 @@
+#include <atomic>
+#include <iostream>
+#include <pqrs/local_datagram.hpp>
+
+namespace {
+// Measure the per-message cost from `async_send` until the message is processed.
+void run_send_benchmark(std::weak_ptr<pqrs::dispatcher::dispatcher> weak_dispatcher,
+                        size_t message_size,
+                        size_t message_count) {
+  std::filesystem::path server_socket_file_path("tmp/server.sock");
+  size_t buffer_size = 32 * 1024;
+
+  //
+  // server
+  //
+
+  std::atomic<size_t> received_count(0);
+  std::atomic<std::chrono::steady_clock::rep> received_time(0);
+
+  auto server = std::make_unique<pqrs::local_datagram::server>(weak_dispatcher,
+                                                               server_socket_file_path,
+                                                               buffer_size);
+  server->set_inline_received_handler([&received_count, &received_time](auto&& buffer, auto&& sender_endpoint) {
+    received_time = std::chrono::steady_clock::now().time_since_epoch().count();
+    ++received_count;
+  });
+
+  {
+    auto wait = pqrs::make_thread_wait();
+
+    server->bound.connect([wait] {
+      wait->notify();
+    });
+
+    server->async_start();
+
+    wait->wait_notice();
+  }
+
+  //
+  // client
+  //
+
+  auto client = std::make_unique<pqrs::local_datagram::client>(weak_dispatcher,
+                                                               server_socket_file_path,
+                                                               std::nullopt,
+                                                               buffer_size);
+
+  {
+    auto wait = pqrs::make_thread_wait();
+
+    client->connected.connect([wait](auto&& peer_pid) {
+      wait->notify();
+    });
+
+    client->async_start();
+
+    wait->wait_notice();
+  }
+
+  //
+  // send
+  //
+
+  std::vector<uint8_t> buffer(message_size, 'x');
+  auto wait = pqrs::make_thread_wait();
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < message_count; ++i) {
+    if (i == message_count - 1) {
+      client->async_send(buffer, [wait] {
+        wait->notify();
+      });
+    } else {
+      client->async_send(buffer);
+    }
+  }
+
+  auto enqueued = std::chrono::steady_clock::now();
+
+  wait->wait_notice();
+
+  auto processed = std::chrono::steady_clock::now();
+
+  auto ns_per_message = [](auto&& duration, size_t count) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / count;
+  };
+
+  std::cout << "message size: " << message_size
+            << ", count: " << message_count
+            << ", enqueue: " << ns_per_message(enqueued - start, message_count) << " ns/message"
+            << ", processed: " << ns_per_message(processed - start, message_count) << " ns/message"
+            << std::endl;
+
+  //
+  // async_send_batch
+  //
+
+  constexpr size_t batch_message_count = 500;
+  std::vector<std::vector<uint8_t>> batch(batch_message_count, buffer);
+  auto batch_count = message_count / batch_message_count;
+  auto batch_start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < batch_count; ++i) {
+    auto w = pqrs::make_thread_wait();
+    client->async_send_batch(batch, [w] {
+      w->notify();
+    });
+    w->wait_notice();
+  }
+
+  auto batch_processed = std::chrono::steady_clock::now();
+
+  std::cout << "message size: " << message_size
+            << ", count: " << batch_count * batch_message_count
+            << ", async_send_batch: " << ns_per_message(batch_processed - batch_start, batch_count * batch_message_count) << " ns/message"
+            << std::endl;
+
+  //
+  // send one by one (the sender is idle for each message)
+  //
+
+  auto idle_message_count = message_count / 10;
+  auto idle_start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < idle_message_count; ++i) {
+    auto w = pqrs::make_thread_wait();
+    client->async_send(buffer, [w] {
+      w->notify();
+    });
+    w->wait_notice();
+  }
+
+  auto idle_processed = std::chrono::steady_clock::now();
+
+  std::cout << "message size: " << message_size
+            << ", count: " << idle_message_count
+            << ", processed one by one: " << ns_per_message(idle_processed - idle_start, idle_message_count) << " ns/message"
+            << std::endl;
+
+  //
+  // send one by one until the server receives the message
+  //
+  // This excludes the dispatcher round trip of `processed`,
+  // and measures the sender wakeup and `sendmsg` on the io thread (plus the receive on the server io thread).
+  //
+
+  std::chrono::nanoseconds received_latency(0);
+
+  for (size_t i = 0; i < idle_message_count; ++i) {
+    auto expected_received_count = received_count + 1;
+    auto send_time = std::chrono::steady_clock::now();
+
+    client->async_send(buffer);
+
+    while (received_count < expected_received_count) {
+      std::this_thread::yield();
+    }
+
+    received_latency += std::chrono::steady_clock::duration(received_time.load()) - send_time.time_since_epoch();
+  }
+
+  std::cout << "message size: " << message_size
+            << ", count: " << idle_message_count
+            << ", received one by one: " << ns_per_message(received_latency, idle_message_count) << " ns/message"
+            << std::endl;
+
+  //
+  // try_send one by one
+  //
+
+  auto try_send_start = std::chrono::steady_clock::now();
+  size_t try_send_fast_path_count = 0;
+
+  for (size_t i = 0; i < idle_message_count; ++i) {
+    auto w = pqrs::make_thread_wait();
+    if (client->try_send(buffer, [w] {
+          w->notify();
+        })) {
+      ++try_send_fast_path_count;
+    }
+    w->wait_notice();
+  }
+
+  auto try_send_processed = std::chrono::steady_clock::now();
+
+  std::cout << "message size: " << message_size
+            << ", count: " << idle_message_count
+            << ", try_send one by one: " << ns_per_message(try_send_processed - try_send_start, idle_message_count) << " ns/message"
+            << " (fast path: " << try_send_fast_path_count << ")"
+            << std::endl;
+
+  client = nullptr;
+  server = nullptr;
+
+  std::cout << "received: " << received_count << std::endl;
+}
+} // namespace
+
+int main() {
+  auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+  auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+  for (const auto& message_size : {8, 256, 4096}) {
+    run_send_benchmark(dispatcher,
+                       message_size,
+                       100000);
+  }
+
+  dispatcher->terminate();
+  dispatcher = nullptr;
+
+  return 0;
+}
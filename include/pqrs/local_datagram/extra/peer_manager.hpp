@@ -58,15 +58,15 @@ public:
       verified_ = value;
     }
 
-    void async_send(const std::vector<uint8_t>& v) {
+    void async_send(std::vector<uint8_t>&& v) {
       flush();
 
       if (connected_ && verified_) {
-        client_.async_send(v);
+        client_.async_send(std::move(v));
       } else {
         // Since we cannot verify before the connection is established,
         // enqueue pre-connection items and evaluate them after connected.
-        queue_.emplace_back(v);
+        queue_.push_back(std::move(v));
       }
     }
 
@@ -76,8 +76,8 @@ public:
       }
 
       if (verified_) {
-        for (const auto& v : queue_) {
-          client_.async_send(v);
+        for (auto&& v : queue_) {
+          client_.async_send(std::move(v));
         }
       }
 
@@ -112,7 +112,14 @@ public:
 
   void async_send(const std::filesystem::path& peer_socket_file_path,
                   const std::vector<uint8_t>& v) {
-    enqueue_to_dispatcher([this, peer_socket_file_path, v] {
+    async_send(peer_socket_file_path,
+               std::vector<uint8_t>(v));
+  }
+
+  // `v` is moved to the peer client without copying.
+  void async_send(const std::filesystem::path& peer_socket_file_path,
+                  std::vector<uint8_t>&& v) {
+    enqueue_to_dispatcher([this, peer_socket_file_path, v = std::move(v)] mutable {
       auto [it, inserted] = entries_.try_emplace(peer_socket_file_path,
                                                  std::make_shared<entry>(weak_dispatcher_,
                                                                          peer_socket_file_path,
@@ -160,7 +167,7 @@ public:
         it->second->get_client().async_start();
       }
 
-      it->second->async_send(v);
+      it->second->async_send(std::move(v));
     });
   }
 
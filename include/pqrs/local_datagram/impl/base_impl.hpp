@@ -7,18 +7,37 @@
 // `pqrs::local_datagram::impl::base_impl` can be used safely in a multi-threaded environment.
 
 #include "../helper.hpp"
+#include "../received_datagram.hpp"
+#include "../send_queue_overflow_policy.hpp"
+#include "../send_status.hpp"
 #include "asio_helper.hpp"
-#include "next_heartbeat_deadline_timer.hpp"
+#include "endpoint_intern_table.hpp"
+#include "next_heartbeat_deadline_wheel.hpp"
+#include "receive_channel.hpp"
+#include "receive_buffer_pool.hpp"
 #include "send_entry.hpp"
+#include "send_entry_pool.hpp"
+#include "send_fast_path.hpp"
+#include "send_handoff_queue.hpp"
+#include "send_queue.hpp"
+#include "socket_file_probe.hpp"
+#include "socket_file_watcher.hpp"
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <cerrno>
 #include <cstring>
 #include <deque>
 #include <filesystem>
+#include <limits>
 #include <nod/nod.hpp>
 #include <optional>
 #include <pqrs/dispatcher.hpp>
 #include <pqrs/gsl.hpp>
+#include <span>
+#include <string>
+#include <sys/socket.h>
+#include <unordered_map>
 
 namespace pqrs::local_datagram::impl {
 class base_impl : public dispatcher::extra::dispatcher_client {
@@ -28,30 +47,90 @@ public:
   nod::signal<void(const std::string&)> warning_reported;
   nod::signal<void()> bound;
   nod::signal<void(const asio::error_code&)> bind_failed;
+  // `sender_endpoint` is interned by `endpoint_intern_table_` and shared with the heartbeat wheel and reply entries.
+  // Slots must not modify it.
   nod::signal<void(not_null_shared_ptr_t<std::vector<uint8_t>>,
                    not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint> sender_endpoint)>
       received;
-  nod::signal<void()> closed;
+  // `received_batch` is emitted instead of `received` when `set_receive_batch_size` is specified.
+  nod::signal<void(not_null_shared_ptr_t<std::vector<received_datagram>>)> received_batch;
+  // `socket_file_removed` is true when the socket is closed because the bound socket file is removed.
+  nod::signal<void(bool socket_file_removed)> closed;
   nod::signal<void(not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint> sender_endpoint)> next_heartbeat_deadline_exceeded;
   nod::signal<void(const asio::error_code&)> error_occurred;
+  // `send_queue_high_watermark` is emitted when the number of queued entries reaches the high watermark.
+  // `send_queue_low_watermark` is emitted when the number of queued entries falls to the low watermark after that.
+  nod::signal<void()> send_queue_high_watermark;
+  nod::signal<void()> send_queue_low_watermark;
+  // `send_entry_expired` is emitted with the number of entries which are dropped because they are not sent until their deadlines.
+  // (It is emitted once for entries which are dropped at the same time.)
+  nod::signal<void(size_t)> send_entry_expired;
 
   enum class mode {
     server,
     client,
   };
 
+  static constexpr size_t default_receive_buffer_pool_size = 32;
+  static constexpr size_t default_send_entry_pool_size = 32;
+  static constexpr size_t default_send_entry_inline_payload_size = 256;
+  static constexpr size_t default_no_buffer_space_unsent_entry_retry_limit = 10;
+  static constexpr size_t default_no_buffer_space_retry_limit = 100;
+  static constexpr std::chrono::milliseconds default_send_deadline{5000};
+
 protected:
+  enum class sender_state {
+    // No entry is in flight. `async_send` starts sending immediately.
+    idle,
+    // An entry (or a batch of entries) is in flight.
+    sending,
+    // Waiting for `send_retry_timer_` (or the socket writability in client mode) to retry sending.
+    waiting_retry,
+  };
+
+  // The retry interval after no_buffer_space error is doubled from the minimum interval for each error.
+  static constexpr std::chrono::milliseconds no_buffer_space_minimum_retry_interval{1};
+  static constexpr std::chrono::milliseconds no_buffer_space_maximum_retry_interval{100};
+
+  // The capabilities of peers are forgotten when the number of peers exceeds this value.
+  // (Batches are not sent until the peers send their capabilities again.)
+  static constexpr size_t maximum_peer_capabilities_count = 4096;
+
+  // The polling check is used only as a fallback of the watcher while the watcher is available.
+  static constexpr std::chrono::milliseconds watched_socket_file_check_interval{10000};
+
   base_impl(const base_impl&) = delete;
 
   base_impl(std::weak_ptr<dispatcher::dispatcher> weak_dispatcher,
             mode mode,
-            not_null_shared_ptr_t<std::deque<not_null_shared_ptr_t<send_entry>>> send_entries)
+            not_null_shared_ptr_t<send_queue> send_entries,
+            not_null_shared_ptr_t<send_fast_path> send_fast_path)
       : dispatcher_client(weak_dispatcher),
         mode_(mode),
         send_entries_(send_entries),
+        send_fast_path_(send_fast_path),
         work_guard_(asio::make_work_guard(io_ctx_)),
         socket_ready_(false),
-        send_invoker_(io_ctx_, asio_helper::time_point::pos_infin()),
+        buffer_size_(0),
+        receive_buffer_pool_size_(default_receive_buffer_pool_size),
+        receive_paused_(false),
+        user_data_as_heartbeat_(false),
+        user_data_sent_(false),
+        peer_user_data_as_heartbeat_(false),
+        socket_file_watch_(false),
+        socket_file_removed_(false),
+        next_heartbeat_deadline_timer_(io_ctx_, asio_helper::time_point::pos_infin()),
+        send_queue_overflow_policy_(send_queue_overflow_policy::drop_newest),
+        send_queue_low_watermark_(0),
+        send_queue_above_high_watermark_(false),
+        no_buffer_space_unsent_entry_retry_limit_(default_no_buffer_space_unsent_entry_retry_limit),
+        no_buffer_space_retry_limit_(default_no_buffer_space_retry_limit),
+        send_deadline_duration_(default_send_deadline),
+        sender_state_(sender_state::idle),
+        waiting_writable_(false),
+        no_buffer_space_parked_(false),
+        send_queue_empty_(true),
+        send_retry_timer_(io_ctx_, asio_helper::time_point::pos_infin()),
         send_deadline_(io_ctx_, asio_helper::time_point::pos_infin()) {
     io_ctx_thread_ = std::thread([this] {
       this->io_ctx_.run();
@@ -64,6 +143,22 @@ protected:
   // We have to terminate asio and pqrs::dispatcher while all instance variables of child class are alive.
   // Thus, `base_impl::terminate` is provided to terminate in the decstructor of child class.
   void terminate_base_impl() {
+    //
+    // send_handoff_queue
+    //
+
+    if (send_handoff_queue_) {
+      send_handoff_queue_->suspend(this);
+    }
+
+    //
+    // receive_channel
+    //
+
+    if (receive_channel_) {
+      receive_channel_->cancel_resume();
+    }
+
     //
     // asio
     //
@@ -88,6 +183,8 @@ protected:
       return;
     }
 
+    buffer_size_ = buffer_size;
+
     //
     // receive options
     //
@@ -97,6 +194,29 @@ protected:
     receive_buffer_.resize(buffer_size + buffer_margin);
     socket_->set_option(asio::socket_base::receive_buffer_size(receive_buffer_.size()));
 
+    if (receive_buffer_pool_size_ > 0) {
+      receive_buffer_pool_ = std::make_shared<receive_buffer_pool>(receive_buffer_.size(),
+                                                                   receive_buffer_pool_size_);
+    } else {
+      receive_buffer_pool_ = nullptr;
+    }
+
+#ifdef __linux__
+    if (receive_batch_size_) {
+      receive_batch_buffers_.assign(*receive_batch_size_, std::vector<uint8_t>(receive_buffer_.size()));
+      receive_batch_sender_endpoints_.assign(*receive_batch_size_, asio::local::datagram_protocol::endpoint());
+      receive_batch_iovecs_.assign(*receive_batch_size_, iovec{});
+      receive_batch_headers_.assign(*receive_batch_size_, mmsghdr{});
+    }
+#else
+    if (receive_batch_size_ ||
+        send_batch_size_ ||
+        mode_ == mode::server) {
+      asio::error_code error_code;
+      socket_->non_blocking(true, error_code);
+    }
+#endif
+
     //
     // send options
     //
@@ -110,7 +230,30 @@ protected:
     // Sender
     //
 
-    await_send_entry(std::nullopt);
+    sender_state_ = sender_state::idle;
+    waiting_writable_ = false;
+    no_buffer_space_parked_ = false;
+    send_queue_empty_ = send_entries_->empty();
+    send_fast_path_->set_queued(!send_queue_empty_);
+    await_send_entry();
+
+    // The fast path is available only for the connected socket.
+    if (mode_ == mode::client &&
+        socket_) {
+      send_fast_path_->enable(socket_->native_handle());
+    }
+
+    // Capabilities of the previous peers are obsolete.
+    peer_max_batch_sizes_.clear();
+    peer_user_data_as_heartbeat_ = false;
+
+    // Ask the server capabilities.
+    // (The server cannot reply if the client socket is not bound.)
+    if (mode_ == mode::client &&
+        !bound_path_.empty()) {
+      send_capabilities(nullptr,
+                        true);
+    }
 
     send_deadline_.expires_at(asio_helper::time_point::pos_infin());
     if (mode_ == mode::client) {
@@ -125,8 +268,149 @@ protected:
   }
 
 public:
+  // Drain up to `value` datagrams per readiness event and emit them by `received_batch` instead of `received`.
+  // (`recvmmsg` is used on Linux.)
+  //
+  // You have to call `set_receive_batch_size` before `async_bind` or `async_connect`.
+  void set_receive_batch_size(std::optional<size_t> value) {
+    if (value) {
+      value = std::max(*value, size_t(1));
+    }
+
+    asio::post(io_ctx_, [this, value] {
+      receive_batch_size_ = value;
+    });
+  }
+
+  // Set the maximum number of pooled receive buffers which are passed to `received`.
+  // Receive buffers are allocated from the heap if `value` == 0.
+  //
+  // You have to call `set_receive_buffer_pool_size` before `async_bind` or `async_connect`.
+  void set_receive_buffer_pool_size(size_t value) {
+    asio::post(io_ctx_, [this, value] {
+      receive_buffer_pool_size_ = value;
+    });
+  }
+
+  // Send up to `value` queued entries by a single system call without waiting for each completion.
+  // (`sendmmsg` is used on Linux.)
+  //
+  // You have to call `set_send_batch_size` before `async_bind` or `async_connect`.
+  void set_send_batch_size(std::optional<size_t> value) {
+    if (value) {
+      value = std::max(*value, size_t(1));
+    }
+
+    asio::post(io_ctx_, [this, value] {
+      send_batch_size_ = value;
+    });
+  }
+
+  // Limit the send queue by the number of entries and the total bytes.
+  // `policy` is applied when `async_send` is called while the send queue is full.
+  //
+  // You have to call `set_send_queue_limit` before `async_bind` or `async_connect`.
+  void set_send_queue_limit(std::optional<size_t> max_entry_count,
+                            std::optional<size_t> max_bytes,
+                            send_queue_overflow_policy policy) {
+    asio::post(io_ctx_, [this, max_entry_count, max_bytes, policy] {
+      send_queue_max_entry_count_ = max_entry_count;
+      send_queue_max_bytes_ = max_bytes;
+      send_queue_overflow_policy_ = policy;
+    });
+  }
+
+  // Emit `send_queue_high_watermark` and `send_queue_low_watermark` by the number of queued entries.
+  // The signals are not emitted if `high_watermark` == std::nullopt.
+  //
+  // You have to call `set_send_queue_watermarks` before `async_bind` or `async_connect`.
+  void set_send_queue_watermarks(std::optional<size_t> high_watermark,
+                                 size_t low_watermark) {
+    asio::post(io_ctx_, [this, high_watermark, low_watermark] {
+      send_queue_high_watermark_ = high_watermark;
+      send_queue_low_watermark_ = low_watermark;
+    });
+  }
+
+  // Coalesce small user data into a batch datagram if `linger_window` != std::nullopt.
+  // The first entry of the batch waits `linger_window` in order to coalesce following user data.
+  // Batches are sent only to peers which accept them by capabilities.
+  // (Entries which have the deadline are not coalesced.)
+  //
+  // You have to call `set_send_coalescing` before `async_bind` or `async_connect`.
+  void set_send_coalescing(std::optional<std::chrono::microseconds> linger_window) {
+    asio::post(io_ctx_, [this, linger_window] {
+      send_coalescing_linger_window_ = linger_window;
+    });
+  }
+
+  // The connection is closed if sending an entry is not finished within `value` in client mode.
+  //
+  // You have to call `set_send_deadline` before `async_bind` or `async_connect`.
+  void set_send_deadline(std::chrono::milliseconds value) {
+    asio::post(io_ctx_, [this, value] {
+      send_deadline_duration_ = value;
+    });
+  }
+
+  // Client: Skip a heartbeat when user data is sent within the server check interval.
+  //         (Only after the server confirms that it treats user data as a heartbeat by capabilities.)
+  // Server: Treat user data from an endpoint which has an active heartbeat deadline as a heartbeat.
+  //
+  // You have to call `set_user_data_as_heartbeat` before `async_bind` or `async_connect`.
+  void set_user_data_as_heartbeat(bool value) {
+    asio::post(io_ctx_, [this, value] {
+      user_data_as_heartbeat_ = value;
+    });
+  }
+
+  // Watch the bound socket file with inotify in addition to the polling check. (Linux only)
+  //
+  // You have to call `set_socket_file_watch` before `async_bind` or `async_connect`.
+  void set_socket_file_watch(bool value) {
+    asio::post(io_ctx_, [this, value] {
+      socket_file_watch_ = value;
+    });
+  }
+
+  // Set how many times sending an entry is retried when `send` returns no_buffer_space error.
+  // The entry is dropped when the error is continued more than `unsent_entry_retry_limit` times and no byte of the entry has been sent,
+  // or when the error is continued more than `retry_limit` times.
+  //
+  // You have to call `set_no_buffer_space_retry_limits` before `async_bind` or `async_connect`.
+  void set_no_buffer_space_retry_limits(size_t unsent_entry_retry_limit,
+                                        size_t retry_limit) {
+    asio::post(io_ctx_, [this, unsent_entry_retry_limit, retry_limit] {
+      no_buffer_space_unsent_entry_retry_limit_ = unsent_entry_retry_limit;
+      no_buffer_space_retry_limit_ = retry_limit;
+    });
+  }
+
+  // Set a handler which is called in `io_ctx_thread_` for each received user data instead of `received` and `received_batch`.
+  // `buffer` and `sender_endpoint` refer to the internal receive buffer and are valid only while the handler is running.
+  //
+  // You have to call `set_inline_received_handler` before `async_bind` or `async_connect`.
+  void set_inline_received_handler(std::function<void(std::span<const uint8_t> buffer,
+                                                      const asio::local::datagram_protocol::endpoint& sender_endpoint)> value) {
+    asio::post(io_ctx_, [this, value] {
+      inline_received_handler_ = value;
+    });
+  }
+
+  // Pass received user data to `channel` instead of `received` and `received_batch`.
+  //
+  // You have to call `set_receive_channel` before `async_bind` or `async_connect`.
+  void set_receive_channel(std::shared_ptr<receive_channel> channel) {
+    asio::post(io_ctx_, [this, channel] {
+      receive_channel_ = channel;
+    });
+  }
+
   void async_close() {
     asio::post(io_ctx_, [this] {
+      auto socket_file_removed = socket_file_removed_;
+      socket_file_removed_ = false;
+
       if (!socket_) {
         return;
       }
@@ -138,11 +422,15 @@ public:
       asio::error_code error_code;
 
       socket_->cancel(error_code);
+      send_fast_path_->disable();
+
       socket_->close(error_code);
 
       socket_ = nullptr;
 
-      send_invoker_.cancel();
+      socket_file_watcher_ = nullptr;
+
+      send_retry_timer_.cancel();
       send_deadline_.cancel();
 
       //
@@ -151,7 +439,7 @@ public:
 
       if (socket_ready_) {
         socket_ready_ = false;
-        ++next_heartbeat_deadline_timers_generation_;
+        reset_next_heartbeat_deadlines();
 
         if (!bound_path_.empty()) {
           std::error_code error_code;
@@ -160,9 +448,8 @@ public:
           bound_path_.clear();
         }
 
-        enqueue_to_dispatcher([this] {
-          next_heartbeat_deadline_timers_.clear();
-          closed();
+        enqueue_to_dispatcher([this, socket_file_removed] {
+          closed(socket_file_removed);
         });
       }
     });
@@ -177,80 +464,46 @@ public:
       return;
     }
 
+    // Stop reading the socket while `receive_channel_` is full.
+    if (receive_channel_) {
+      receive_paused_ = !receive_channel_->wait_for_room([this] {
+        asio::post(io_ctx_, [this] {
+          if (receive_paused_) {
+            receive_paused_ = false;
+            async_receive();
+          }
+        });
+      });
+
+      if (receive_paused_) {
+        return;
+      }
+    }
+
+    if (receive_batch_size_) {
+      socket_->async_wait(asio::socket_base::wait_read,
+                          [this](auto&& error_code) {
+                            if (!error_code) {
+                              receive_batch();
+                            }
+
+                            // receive once if not closed
+
+                            if (socket_ready_) {
+                              async_receive();
+                            }
+                          });
+      return;
+    }
+
     socket_->async_receive_from(asio::buffer(receive_buffer_),
                                 receive_sender_endpoint_,
                                 [this](auto&& error_code, auto&& bytes_transferred) {
                                   if (!error_code) {
-                                    if (bytes_transferred > 0) {
-                                      auto t = send_entry::type(receive_buffer_[0]);
-                                      switch (t) {
-                                        case send_entry::type::heartbeat:
-                                          if (bytes_transferred - 1 >= sizeof(uint32_t)) {
-                                            uint32_t next_heartbeat_deadline = 0;
-                                            std::memcpy(&next_heartbeat_deadline,
-                                                        receive_buffer_.data() + 1,
-                                                        sizeof(next_heartbeat_deadline));
-
-                                            if (next_heartbeat_deadline > 0) {
-                                              if (!non_empty_filesystem_endpoint_path(receive_sender_endpoint_)) {
-                                                enqueue_to_dispatcher([this] {
-                                                  warning_reported("sender endpoint is required when next_heartbeat_deadline is specified");
-                                                });
-                                              } else {
-                                                auto generation = next_heartbeat_deadline_timers_generation_.load();
-                                                std::chrono::milliseconds next_heartbeat_deadline_ms(next_heartbeat_deadline);
-                                                auto sender_endpoint = std::make_shared<asio::local::datagram_protocol::endpoint>(receive_sender_endpoint_);
-
-                                                enqueue_to_dispatcher([this, generation, next_heartbeat_deadline_ms, sender_endpoint] {
-                                                  if (generation != next_heartbeat_deadline_timers_generation_.load()) {
-                                                    return;
-                                                  }
-
-                                                  auto it = std::ranges::find_if(
-                                                      next_heartbeat_deadline_timers_,
-                                                      [sender_endpoint](auto&& t) {
-                                                        return *(t->get_sender_endpoint()) == *sender_endpoint;
-                                                      });
-                                                  if (it == std::end(next_heartbeat_deadline_timers_)) {
-                                                    auto t = std::make_shared<next_heartbeat_deadline_timer>(weak_dispatcher_,
-                                                                                                             sender_endpoint,
-                                                                                                             next_heartbeat_deadline_ms);
-                                                    t->next_heartbeat_deadline_exceeded.connect([this, generation, sender_endpoint] {
-                                                      if (generation != next_heartbeat_deadline_timers_generation_.load()) {
-                                                        return;
-                                                      }
-
-                                                      next_heartbeat_deadline_exceeded(sender_endpoint);
-
-                                                      std::erase_if(next_heartbeat_deadline_timers_,
-                                                                    [sender_endpoint](auto&& t) {
-                                                                      return *(t->get_sender_endpoint()) == *sender_endpoint;
-                                                                    });
-                                                    });
-                                                    next_heartbeat_deadline_timers_.push_back(t);
-                                                  } else {
-                                                    (*it)->set_timer(next_heartbeat_deadline_ms);
-                                                  }
-                                                });
-                                              }
-                                            }
-                                          }
-                                          break;
-
-                                        case send_entry::type::user_data: {
-                                          auto v = std::make_shared<std::vector<uint8_t>>(std::begin(receive_buffer_) + 1,
-                                                                                          std::begin(receive_buffer_) + bytes_transferred);
-
-                                          auto sender_endpoint = std::make_shared<asio::local::datagram_protocol::endpoint>(receive_sender_endpoint_);
-
-                                          enqueue_to_dispatcher([this, v, sender_endpoint] {
-                                            received(v, sender_endpoint);
-                                          });
-
-                                          break;
-                                        }
-                                      }
-                                    }
+                                    handle_received(std::span<const uint8_t>(receive_buffer_.data(),
+                                                                             bytes_transferred),
+                                                    receive_sender_endpoint_,
+                                                    nullptr);
                                   }
 
                                   // receive once if not closed
@@ -261,15 +514,398 @@ public:
                                 });
   }
 
+  // Drain up to `receive_batch_size_` datagrams which are already queued in the socket.
+  // This method is executed in `io_ctx_thread_`.
+  void receive_batch() {
+    if (!socket_) {
+      return;
+    }
+
+    auto batch = std::make_shared<std::vector<received_datagram>>();
+
+#ifdef __linux__
+    // Receive multiple datagrams by a single system call.
+
+    for (size_t i = 0; i < receive_batch_headers_.size(); ++i) {
+      receive_batch_iovecs_[i].iov_base = receive_batch_buffers_[i].data();
+      receive_batch_iovecs_[i].iov_len = receive_batch_buffers_[i].size();
+
+      auto& h = receive_batch_headers_[i].msg_hdr;
+      h = {};
+      h.msg_name = receive_batch_sender_endpoints_[i].data();
+      h.msg_namelen = receive_batch_sender_endpoints_[i].capacity();
+      h.msg_iov = &(receive_batch_iovecs_[i]);
+      h.msg_iovlen = 1;
+    }
+
+    auto count = recvmmsg(socket_->native_handle(),
+                          receive_batch_headers_.data(),
+                          receive_batch_headers_.size(),
+                          MSG_DONTWAIT,
+                          nullptr);
+    if (count < 0) {
+      // EAGAIN means the datagrams are already taken. (e.g., a spurious wakeup)
+      if (errno != EAGAIN &&
+          errno != EWOULDBLOCK &&
+          errno != EINTR) {
+        auto error_code = asio::error_code(errno, asio::error::get_system_category());
+        enqueue_to_dispatcher([this, error_code] {
+          error_occurred(error_code);
+        });
+      }
+    }
+
+    for (int i = 0; i < count; ++i) {
+      auto& sender_endpoint = receive_batch_sender_endpoints_[i];
+      sender_endpoint.resize(receive_batch_headers_[i].msg_hdr.msg_namelen);
+
+      handle_received(std::span<const uint8_t>(receive_batch_buffers_[i].data(),
+                                               receive_batch_headers_[i].msg_len),
+                      sender_endpoint,
+                      batch.get());
+    }
+#else
+    // Receive datagrams until the socket becomes empty.
+
+    for (size_t i = 0; i < *receive_batch_size_; ++i) {
+      asio::error_code error_code;
+      auto bytes_transferred = socket_->receive_from(asio::buffer(receive_buffer_),
+                                                     receive_sender_endpoint_,
+                                                     0,
+                                                     error_code);
+      if (error_code) {
+        if (error_code != asio::error::would_block &&
+            error_code != asio::error::interrupted) {
+          enqueue_to_dispatcher([this, error_code] {
+            error_occurred(error_code);
+          });
+        }
+        break;
+      }
+
+      handle_received(std::span<const uint8_t>(receive_buffer_.data(),
+                                               bytes_transferred),
+                      receive_sender_endpoint_,
+                      batch.get());
+    }
+#endif
+
+    if (!batch->empty()) {
+      enqueue_to_dispatcher([this, batch] {
+        received_batch(batch);
+      });
+    }
+  }
+
+  // Handle a received datagram.
+  // User data is appended into `batch` if `batch` is specified.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void handle_received(std::span<const uint8_t> buffer,
+                       const asio::local::datagram_protocol::endpoint& sender_endpoint,
+                       std::vector<received_datagram>* batch) {
+    if (buffer.empty()) {
+      return;
+    }
+
+    auto t = send_entry::type(buffer[0]);
+    switch (t) {
+      case send_entry::type::heartbeat:
+        if (buffer.size() - 1 >= sizeof(uint32_t)) {
+          uint32_t next_heartbeat_deadline = 0;
+          std::memcpy(&next_heartbeat_deadline,
+                      buffer.data() + 1,
+                      sizeof(next_heartbeat_deadline));
+
+          if (next_heartbeat_deadline > 0) {
+            if (!non_empty_filesystem_endpoint_path(sender_endpoint)) {
+              enqueue_to_dispatcher([this] {
+                warning_reported("sender endpoint is required when next_heartbeat_deadline is specified");
+              });
+            } else {
+              auto&& interned = endpoint_intern_table_.intern(sender_endpoint);
+              auto deadline = asio_helper::time_point::now() + std::chrono::milliseconds(next_heartbeat_deadline);
+
+              next_heartbeat_deadlines_.set(interned.get_id(),
+                                            interned.get_endpoint(),
+                                            deadline,
+                                            std::chrono::milliseconds(next_heartbeat_deadline));
+              schedule_next_heartbeat_deadline_timer(deadline);
+            }
+          }
+        }
+        break;
+
+      case send_entry::type::user_data:
+        refresh_next_heartbeat_deadline(sender_endpoint);
+        handle_received_user_data(buffer.subspan(1),
+                                  sender_endpoint,
+                                  batch);
+        break;
+
+      case send_entry::type::batch: {
+        refresh_next_heartbeat_deadline(sender_endpoint);
+
+        auto messages = buffer.subspan(1);
+        while (messages.size() >= sizeof(send_entry::batch_message_length_t)) {
+          send_entry::batch_message_length_t length = 0;
+          std::memcpy(&length,
+                      messages.data(),
+                      sizeof(length));
+          messages = messages.subspan(sizeof(length));
+
+          if (messages.size() < length) {
+            break;
+          }
+
+          handle_received_user_data(messages.first(length),
+                                    sender_endpoint,
+                                    batch);
+          messages = messages.subspan(length);
+        }
+        break;
+      }
+
+      case send_entry::type::capabilities:
+        if (buffer.size() - 1 >= sizeof(uint8_t) + sizeof(uint32_t)) {
+          bool reply_requested = buffer[1];
+          uint32_t max_batch_size = 0;
+          std::memcpy(&max_batch_size,
+                      buffer.data() + 2,
+                      sizeof(max_batch_size));
+
+          // Old peers do not send flags.
+          uint8_t flags = 0;
+          if (buffer.size() > 2 + sizeof(max_batch_size)) {
+            flags = buffer[2 + sizeof(max_batch_size)];
+          }
+
+          // All entries have no destination endpoint in client mode.
+          auto key = mode_ == mode::client ? std::string_view()
+                                           : send_queue::make_key(&sender_endpoint);
+          if (mode_ == mode::server &&
+              key.empty()) {
+            break;
+          }
+
+          if (mode_ == mode::client) {
+            peer_user_data_as_heartbeat_ = (flags & send_entry::capability_flag_user_data_as_heartbeat) != 0;
+          }
+
+          if (max_batch_size > 0) {
+            if (peer_max_batch_sizes_.size() >= maximum_peer_capabilities_count &&
+                !peer_max_batch_sizes_.contains(key)) {
+              peer_max_batch_sizes_.clear();
+            }
+            peer_max_batch_sizes_.insert_or_assign(std::string(key), max_batch_size);
+          } else {
+            forget_peer_capabilities(key);
+          }
+
+          if (reply_requested) {
+            std::shared_ptr<const asio::local::datagram_protocol::endpoint> destination_endpoint;
+            if (mode_ == mode::server) {
+              destination_endpoint = endpoint_intern_table_.intern(sender_endpoint).get_endpoint().get();
+            }
+            send_capabilities(destination_endpoint,
+                              false);
+          }
+        }
+        break;
+    }
+  }
+
+  // This method is executed in `io_ctx_thread_`.
+  void handle_received_user_data(std::span<const uint8_t> buffer,
+                                 const asio::local::datagram_protocol::endpoint& sender_endpoint,
+                                 std::vector<received_datagram>* batch) {
+    if (inline_received_handler_) {
+      inline_received_handler_(buffer,
+                               sender_endpoint);
+      return;
+    }
+
+    auto v = make_received_buffer(buffer);
+
+    auto endpoint = endpoint_intern_table_.intern(sender_endpoint).get_endpoint();
+
+    if (receive_channel_) {
+      receive_channel_->push(received_datagram(v, endpoint));
+      return;
+    }
+
+    if (batch) {
+      batch->emplace_back(v, endpoint);
+    } else {
+      enqueue_to_dispatcher([this, v, endpoint] {
+        received(v, endpoint);
+      });
+    }
+  }
+
+  // This method is executed in `io_ctx_thread_`.
+  void forget_peer_capabilities(std::string_view key) {
+    if (auto it = peer_max_batch_sizes_.find(key); it != std::end(peer_max_batch_sizes_)) {
+      peer_max_batch_sizes_.erase(it);
+    }
+  }
+
+  // Close the socket if the bound socket file is removed or replaced.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void check_socket_file(const socket_file_probe& probe) {
+    switch (probe.probe()) {
+      case socket_file_probe::status::reachable:
+        break;
+
+      case socket_file_probe::status::replaced:
+        // Do not remove the file which is owned by another socket.
+        // (The socket is not bound again immediately in order to avoid taking the file back and forth.)
+        bound_path_.clear();
+        async_close();
+        break;
+
+      case socket_file_probe::status::missing:
+      case socket_file_probe::status::unreachable:
+        // The socket file can be bound again immediately since no other socket owns it.
+        socket_file_removed_ = true;
+        async_close();
+        break;
+    }
+  }
+
+  // Forget the heartbeat deadlines of the previous connection.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void reset_next_heartbeat_deadlines() {
+    ++next_heartbeat_deadline_generation_;
+
+    next_heartbeat_deadlines_.clear();
+    next_heartbeat_deadline_timer_.cancel();
+    next_heartbeat_deadline_timer_expiry_ = std::nullopt;
+  }
+
+  // Extend the active heartbeat deadline of `sender_endpoint` when `user_data_as_heartbeat_` is enabled.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void refresh_next_heartbeat_deadline(const asio::local::datagram_protocol::endpoint& sender_endpoint) {
+    if (!user_data_as_heartbeat_ ||
+        next_heartbeat_deadlines_.empty()) {
+      return;
+    }
+
+    auto&& interned = endpoint_intern_table_.intern(sender_endpoint);
+    if (auto deadline = next_heartbeat_deadlines_.refresh(interned.get_id(),
+                                                          asio_helper::time_point::now())) {
+      schedule_next_heartbeat_deadline_timer(*deadline);
+    }
+  }
+
+  // Returns true if user data is sent after the last call.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  bool take_user_data_sent() {
+    auto fast_path_sent = send_fast_path_->take_user_data_sent();
+    auto sent = user_data_sent_ || fast_path_sent;
+    user_data_sent_ = false;
+    return sent;
+  }
+
+  // Make `next_heartbeat_deadline_timer_` expire until `deadline`.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void schedule_next_heartbeat_deadline_timer(asio::steady_timer::time_point deadline) {
+    // The timer is already scheduled before `deadline`.
+    if (next_heartbeat_deadline_timer_expiry_ &&
+        *next_heartbeat_deadline_timer_expiry_ <= deadline) {
+      return;
+    }
+
+    next_heartbeat_deadline_timer_expiry_ = next_heartbeat_deadlines_.get_next_advance_time();
+    if (!next_heartbeat_deadline_timer_expiry_) {
+      next_heartbeat_deadline_timer_.cancel();
+      return;
+    }
+
+    next_heartbeat_deadline_timer_.expires_at(*next_heartbeat_deadline_timer_expiry_);
+    next_heartbeat_deadline_timer_.async_wait(
+        [this](const auto& error_code) {
+          if (error_code == asio::error::operation_aborted) {
+            return;
+          }
+
+          next_heartbeat_deadline_timer_expiry_ = std::nullopt;
+
+          std::vector<not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint>> exceeded_endpoints;
+          next_heartbeat_deadlines_.advance(
+              asio_helper::time_point::now(),
+              [this, &exceeded_endpoints](auto&& sender_endpoint) {
+                forget_peer_capabilities(send_queue::make_key(sender_endpoint.get().get()));
+                exceeded_endpoints.push_back(sender_endpoint);
+              });
+
+          // Only the exceeded endpoints are passed to the dispatcher, and they are passed at once.
+          if (!exceeded_endpoints.empty()) {
+            auto generation = next_heartbeat_deadline_generation_.load();
+            enqueue_to_dispatcher([this, generation, exceeded_endpoints] {
+              for (const auto& sender_endpoint : exceeded_endpoints) {
+                if (generation != next_heartbeat_deadline_generation_.load()) {
+                  return;
+                }
+
+                next_heartbeat_deadline_exceeded(sender_endpoint);
+              }
+            });
+          }
+
+          schedule_next_heartbeat_deadline_timer(asio_helper::time_point::pos_infin());
+        });
+  }
+
+  // This method is executed in `io_ctx_thread_`.
+  not_null_shared_ptr_t<std::vector<uint8_t>> make_received_buffer(std::span<const uint8_t> data) {
+    if (receive_buffer_pool_) {
+      return receive_buffer_pool_->lease(data);
+    }
+
+    return std::make_shared<std::vector<uint8_t>>(std::begin(data),
+                                                  std::end(data));
+  }
+
 #pragma endregion
 
 #pragma region sender
 
 public:
+  // Drain entries pushed into `queue` in `io_ctx_thread_`.
+  // `queue` is suspended when the instance is terminated.
+  void attach_send_handoff_queue(not_null_shared_ptr_t<send_handoff_queue> queue) {
+    send_handoff_queue_ = queue;
+
+    queue->attach(this, [this] {
+      asio::post(io_ctx_, [this] {
+        // Append all drained entries to `send_entries_` before waking the sender
+        // in order to send them in batches.
+        bool queued = false;
+        send_handoff_queue_->drain([this, &queued](auto&& entry) {
+          if (queue_send_entry(entry)) {
+            queued = true;
+          }
+        });
+
+        // `processed` of entries which are dropped by the send queue limit.
+        flush_completed_processed();
+
+        if (queued) {
+          wake_sender();
+        }
+      });
+    });
+  }
+
   void async_send(not_null_shared_ptr_t<send_entry> entry) {
     asio::post(io_ctx_, [this, entry] {
-      send_entries_->push_back(entry);
-      send_invoker_.expires_after(std::chrono::milliseconds(0));
+      accept_send_entry(entry);
     });
   }
 
@@ -279,41 +915,139 @@ protected:
   //
 
   // This method is executed in `io_ctx_thread_`.
-  void await_send_entry(std::optional<std::chrono::milliseconds> delay) {
+  void accept_send_entry(not_null_shared_ptr_t<send_entry> entry) {
+    auto queued = queue_send_entry(entry);
+
+    // `processed` of entries which are dropped by the send queue limit.
+    flush_completed_processed();
+
+    if (queued) {
+      wake_sender();
+    }
+  }
+
+  // Returns true if `entry` is added to `send_entries_`.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  bool queue_send_entry(not_null_shared_ptr_t<send_entry> entry) {
+    if (auto max_batch_size = get_max_batch_size(*entry)) {
+      return coalesce_send_entry(entry,
+                                 *max_batch_size);
+    }
+
+    return push_back_send_entry(entry);
+  }
+
+  // This method is executed in `io_ctx_thread_`.
+  void wake_sender() {
+    // Start sending immediately if the sender is idle.
+    // Otherwise, the entry is sent after the in-flight entry.
+    switch (sender_state_) {
+      case sender_state::idle:
+        await_send_entry();
+        break;
+
+      case sender_state::sending:
+        break;
+
+      case sender_state::waiting_retry:
+        // The entry might be sent to a destination which is not parked.
+        send_retry_timer_.cancel();
+        await_send_entry();
+        break;
+    }
+  }
+
+  // This method is executed in `io_ctx_thread_`.
+  void await_send_entry() {
     if (!socket_ ||
         !socket_ready_) {
+      sender_state_ = sender_state::idle;
       return;
     }
 
-    if (delay || send_entries_->empty()) {
-      // Sleep until new entry is added.
-      if (delay) {
-        send_invoker_.expires_after(*delay);
+    auto now = asio_helper::time_point::now();
+
+    send_ready_entries_.clear();
+    send_entries_->get_ready_entries(send_batch_size_.value_or(1),
+                                     now,
+                                     send_ready_entries_);
+
+    size_t expired_count = 0;
+    while (auto count = drop_expired_send_entries(now)) {
+      expired_count += count;
+
+      // Take entries again in order to fill the batch.
+      send_ready_entries_.clear();
+      send_entries_->get_ready_entries(send_batch_size_.value_or(1),
+                                       now,
+                                       send_ready_entries_);
+    }
+
+    if (expired_count > 0) {
+      enqueue_to_dispatcher([this, expired_count] {
+        send_entry_expired(expired_count);
+      });
+    }
+
+    if (send_ready_entries_.empty()) {
+      if (auto unpark_time = send_entries_->get_unpark_time()) {
+        // All destinations which have entries are parked. (no_buffer_space error or the linger window of batches)
+        // Wait until the first destination is unparked.
+        sender_state_ = sender_state::waiting_retry;
+
+        send_retry_timer_.expires_at(*unpark_time);
+        send_retry_timer_.async_wait(
+            [this](const auto& error_code) {
+              if (error_code == asio::error::operation_aborted) {
+                return;
+              }
+
+              await_send_entry();
+            });
+
+        // The socket becomes writable when the peer's receive buffer is drained in client mode.
+        // Retry sending without waiting for the timer in that case.
+        // (The socket writability does not reflect the buffer of each destination in server mode.)
+        if (mode_ == mode::client &&
+            no_buffer_space_parked_) {
+          await_send_writable();
+        }
+
       } else {
-        send_invoker_.expires_at(asio_helper::time_point::pos_infin());
+        // Sleep until new entry is added. (`async_send` wakes up the sender.)
+        sender_state_ = sender_state::idle;
       }
 
-      send_invoker_.async_wait(
-          [this](const auto& error_code) {
-            await_send_entry(std::nullopt);
-          });
+    } else if (send_batch_size_ ||
+               mode_ == mode::server) {
+      // Entries are sent without waiting the socket writability in server mode
+      // since the writability does not reflect the buffer of each destination.
+      sender_state_ = sender_state::sending;
+
+      send_batch();
 
     } else {
-      auto entry = send_entries_->front();
+      sender_state_ = sender_state::sending;
+
+      auto entry = send_ready_entries_.front();
       auto destination_endpoint = entry->get_destination_endpoint();
 
-      send_deadline_.expires_after(std::chrono::milliseconds(5000));
+      send_ready_entries_.clear();
+      sending_entry_ = entry;
+
+      send_deadline_.expires_after(send_deadline_duration_);
 
       if (destination_endpoint) {
         socket_->async_send_to(
-            entry->make_buffer(),
+            entry->make_buffers(),
             *destination_endpoint,
             [this, entry](const auto& error_code, auto bytes_transferred) {
               handle_send(error_code, bytes_transferred, entry);
             });
       } else {
         socket_->async_send(
-            entry->make_buffer(),
+            entry->make_buffers(),
             [this, entry](const auto& error_code, auto bytes_transferred) {
               handle_send(error_code, bytes_transferred, entry);
             });
@@ -321,21 +1055,208 @@ protected:
     }
   }
 
+  // Drop expired entries in `send_ready_entries_` from `send_entries_`.
+  // Returns the number of dropped entries.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  size_t drop_expired_send_entries(asio::steady_timer::time_point now) {
+    size_t count = 0;
+
+    for (const auto& entry : send_ready_entries_) {
+      if (entry->expired(now)) {
+        send_entries_->erase(*entry);
+        drop_send_entry(entry, send_status::expired, std::nullopt);
+
+        ++count;
+      }
+    }
+
+    if (count > 0) {
+      update_send_queue_watermark();
+      flush_completed_processed();
+    }
+
+    return count;
+  }
+
+  // This method is executed in `io_ctx_thread_`.
+  void await_send_writable() {
+    if (waiting_writable_) {
+      return;
+    }
+
+    waiting_writable_ = true;
+
+    socket_->async_wait(asio::socket_base::wait_write,
+                        [this](const auto& error_code) {
+                          waiting_writable_ = false;
+
+                          if (error_code ||
+                              sender_state_ != sender_state::waiting_retry) {
+                            return;
+                          }
+
+                          no_buffer_space_parked_ = false;
+                          send_entries_->unpark_all();
+
+                          send_retry_timer_.cancel();
+                          await_send_entry();
+                        });
+  }
+
   // This method is executed in `io_ctx_thread_`.
   void handle_send(const asio::error_code& error_code,
                    size_t bytes_transferred,
                    not_null_shared_ptr_t<send_entry> entry) {
-    std::optional<std::chrono::milliseconds> next_delay;
+    send_deadline_.expires_at(asio_helper::time_point::pos_infin());
+    sending_entry_ = nullptr;
+
+    auto connected = process_send_result(error_code,
+                                         bytes_transferred,
+                                         entry);
+
+    flush_completed_processed();
+
+    if (!connected) {
+      return;
+    }
+
+    await_send_entry();
+  }
+
+  // Send up to `send_batch_size_` entries without waiting for each completion.
+  // (A single entry is sent in the same way in server mode when `send_batch_size_` is not specified.)
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void send_batch() {
+    auto count = send_ready_entries_.size();
+
+    size_t sent_count = 0;
+    asio::error_code error_code;
+
+#ifdef __linux__
+    send_batch_iovecs_.resize(count * 2);
+    send_batch_headers_.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+      auto& entry = send_ready_entries_[i];
+      auto buffers = entry->make_buffers();
+
+      for (size_t j = 0; j < buffers.size(); ++j) {
+        send_batch_iovecs_[i * 2 + j].iov_base = const_cast<void*>(buffers[j].data());
+        send_batch_iovecs_[i * 2 + j].iov_len = buffers[j].size();
+      }
+
+      auto& h = send_batch_headers_[i].msg_hdr;
+      h = {};
+      if (auto destination_endpoint = entry->get_destination_endpoint()) {
+        h.msg_name = const_cast<void*>(static_cast<const void*>(destination_endpoint->data()));
+        h.msg_namelen = destination_endpoint->size();
+      }
+      h.msg_iov = &(send_batch_iovecs_[i * 2]);
+      h.msg_iovlen = 2;
+    }
+
+    auto r = sendmmsg(socket_->native_handle(),
+                      send_batch_headers_.data(),
+                      count,
+                      MSG_DONTWAIT);
+    if (r < 0) {
+      error_code = asio::error_code(errno, asio::error::get_system_category());
+    } else {
+      sent_count = r;
+    }
+
+    for (size_t i = 0; i < sent_count; ++i) {
+      process_send_result(asio::error_code(),
+                          send_batch_headers_[i].msg_len,
+                          send_ready_entries_[i]);
+    }
+#else
+    for (; sent_count < count; ++sent_count) {
+      auto& entry = send_ready_entries_[sent_count];
+
+      size_t bytes_transferred = 0;
+      if (auto destination_endpoint = entry->get_destination_endpoint()) {
+        bytes_transferred = socket_->send_to(entry->make_buffers(),
+                                             *destination_endpoint,
+                                             0,
+                                             error_code);
+      } else {
+        bytes_transferred = socket_->send(entry->make_buffers(),
+                                          0,
+                                          error_code);
+      }
+
+      if (error_code) {
+        break;
+      }
+
+      process_send_result(asio::error_code(),
+                          bytes_transferred,
+                          entry);
+    }
+#endif
+
+    //
+    // Handle the error of the first unsent entry.
+    //
+
+    if (error_code == asio::error::would_block &&
+        mode_ == mode::client) {
+      send_ready_entries_.clear();
+      flush_completed_processed();
+
+      // Wait until the socket becomes writable.
+
+      send_deadline_.expires_after(send_deadline_duration_);
+
+      socket_->async_wait(asio::socket_base::wait_write,
+                          [this](auto&& error_code) {
+                            send_deadline_.expires_at(asio_helper::time_point::pos_infin());
+
+                            await_send_entry();
+                          });
+      return;
+
+    } else if (error_code) {
+      if (!process_send_result(error_code,
+                               0,
+                               send_ready_entries_[sent_count])) {
+        send_ready_entries_.clear();
+        flush_completed_processed();
+        return;
+      }
+    }
+
+    send_ready_entries_.clear();
+    flush_completed_processed();
+
+    // Post in order to give the receiver a chance to run between batches.
+    asio::post(io_ctx_, [this] {
+      await_send_entry();
+    });
+  }
 
+  // Update `entry` and `send_entries_` by the send result.
+  // Returns false if the connection is closed.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  bool process_send_result(const asio::error_code& error_code,
+                           size_t bytes_transferred,
+                           not_null_shared_ptr_t<send_entry> entry) {
     entry->add_bytes_transferred(bytes_transferred);
 
-    send_deadline_.expires_at(asio_helper::time_point::pos_infin());
+    auto status = send_status::sent;
 
     //
     // Handle error.
     //
 
-    if (error_code == asio::error::no_buffer_space) {
+    // The receive buffer of the destination is full.
+    // (Linux returns would_block instead of no_buffer_space in server mode.)
+    if (error_code == asio::error::no_buffer_space ||
+        (error_code == asio::error::would_block && mode_ == mode::server)) {
       //
       // Retrying the sending data or abort the buffer is required.
       //
@@ -347,7 +1268,7 @@ protected:
       entry->set_no_buffer_space_error_count(
           entry->get_no_buffer_space_error_count() + 1);
 
-      if (entry->get_no_buffer_space_error_count() > 10) {
+      if (entry->get_no_buffer_space_error_count() > no_buffer_space_unsent_entry_retry_limit_) {
         // `send` always returns no_buffer_space error on macOS
         // when entry->buffer_.size() > server_buffer_size.
         //
@@ -356,10 +1277,11 @@ protected:
 
         if (entry->get_bytes_transferred() == 0 ||
             // Abort if too many errors
-            entry->get_no_buffer_space_error_count() > 100) {
+            entry->get_no_buffer_space_error_count() > no_buffer_space_retry_limit_) {
           // Drop entry
 
           entry->add_bytes_transferred(entry->rest_bytes());
+          status = send_status::dropped_no_buffer_space;
 
           enqueue_to_dispatcher([this, error_code] {
             error_occurred(error_code);
@@ -367,8 +1289,11 @@ protected:
         }
       }
 
-      // Wait until buffer is available.
-      next_delay = std::chrono::milliseconds(100);
+      // Park the destination until buffer is available.
+      // (Entries for other destinations are sent while the destination is parked.)
+      no_buffer_space_parked_ = true;
+      send_entries_->park(entry->get_destination_endpoint().get(),
+                          asio_helper::time_point::now() + no_buffer_space_retry_interval(entry->get_no_buffer_space_error_count()));
 
     } else if (error_code == asio::error::message_size) {
       //
@@ -379,6 +1304,7 @@ protected:
       //
 
       entry->add_bytes_transferred(entry->rest_bytes());
+      status = send_status::dropped_message_size;
 
       enqueue_to_dispatcher([this, error_code] {
         error_occurred(error_code);
@@ -395,13 +1321,18 @@ protected:
       // Ignore error if server mode.
       if (mode_ == mode::server) {
         entry->add_bytes_transferred(entry->rest_bytes());
+        status = send_status::closed;
+
+        // The peer might be restarted by an old binary which does not accept batches.
+        // (The peer has to send its capabilities again.)
+        forget_peer_capabilities(send_queue::make_key(entry->get_destination_endpoint().get()));
       } else {
         enqueue_to_dispatcher([this, error_code] {
           error_occurred(error_code);
         });
 
         async_close();
-        return;
+        return false;
       }
     }
 
@@ -410,26 +1341,268 @@ protected:
     //
 
     if (entry->transfer_complete()) {
-      pop_front_send_entry();
+      pop_send_entry(entry,
+                     status);
+    }
+
+    return true;
+  }
+
+  // Returns the maximum batch size if `entry` can be coalesced into a batch.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  std::optional<size_t> get_max_batch_size(const send_entry& entry) const {
+    if (!send_coalescing_linger_window_ ||
+        entry.get_type() != send_entry::type::user_data ||
+        entry.get_deadline() ||
+        entry.get_payload().size() > std::numeric_limits<send_entry::batch_message_length_t>::max()) {
+      return std::nullopt;
+    }
+
+    auto it = peer_max_batch_sizes_.find(send_queue::make_key(entry.get_destination_endpoint().get()));
+    if (it == std::end(peer_max_batch_sizes_)) {
+      return std::nullopt;
     }
 
-    await_send_entry(next_delay);
+    auto max_batch_size = std::min(it->second, buffer_size_);
+    if (send_entry::batch_message_size(entry.get_payload()) > max_batch_size) {
+      return std::nullopt;
+    }
+
+    return max_batch_size;
   }
 
+  // Append the payload of `entry` into the last batch for the destination, or push a new batch.
+  // Returns false if the entry is dropped.
+  //
   // This method is executed in `io_ctx_thread_`.
-  void pop_front_send_entry() {
-    if (send_entries_->empty()) {
-      return;
+  bool coalesce_send_entry(not_null_shared_ptr_t<send_entry> entry,
+                           size_t max_batch_size) {
+    auto destination_endpoint = entry->get_destination_endpoint();
+    auto message = entry->get_payload();
+    auto message_size = send_entry::batch_message_size(message);
+
+    auto last = send_entries_->back(destination_endpoint.get());
+    if (last &&
+        last->get_type() == send_entry::type::batch &&
+        last != sending_entry_ &&
+        last->get_bytes_transferred() == 0) {
+      if (last->get_payload().size() + message_size <= max_batch_size) {
+        if (!send_queue_full(message_size)) {
+          last->append_batch_message(message,
+                                     entry->get_processed());
+          last->take_completions(*entry);
+          send_entries_->add_bytes(message_size);
+          return true;
+        }
+      } else {
+        // The last batch is full. Send it without waiting the linger window.
+        send_entries_->unpark(destination_endpoint.get());
+      }
+    }
+
+    auto batch = std::make_shared<send_entry>(send_entry::type::batch,
+                                              destination_endpoint);
+    batch->append_batch_message(message,
+                                entry->get_processed());
+    batch->take_completions(*entry);
+
+    if (!push_back_send_entry(batch)) {
+      return false;
+    }
+
+    // Wait the linger window if the batch is the first entry for the destination.
+    if (!last &&
+        *send_coalescing_linger_window_ > std::chrono::microseconds(0)) {
+      send_entries_->park(destination_endpoint.get(),
+                          asio_helper::time_point::now() + *send_coalescing_linger_window_);
+    }
+
+    return true;
+  }
+
+  // This method is executed in `io_ctx_thread_`.
+  void send_capabilities(std::shared_ptr<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                         bool reply_requested) {
+    // Batches are always accepted up to the buffer size.
+    uint32_t max_batch_size = buffer_size_;
+
+    uint8_t flags = 0;
+    if (user_data_as_heartbeat_) {
+      flags |= send_entry::capability_flag_user_data_as_heartbeat;
+    }
+
+    std::array<uint8_t, sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint8_t)> v;
+    v[0] = reply_requested;
+    std::memcpy(v.data() + 1,
+                &max_batch_size,
+                sizeof(max_batch_size));
+    v[1 + sizeof(max_batch_size)] = flags;
+
+    async_send(std::make_shared<send_entry>(send_entry::type::capabilities,
+                                            v.data(),
+                                            v.size(),
+                                            destination_endpoint));
+  }
+
+  // Append `entry` into `send_entries_` with applying the send queue limit.
+  // Returns false if `entry` is dropped.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  bool push_back_send_entry(not_null_shared_ptr_t<send_entry> entry) {
+    while (send_queue_full(entry->size())) {
+      switch (send_queue_overflow_policy_) {
+        case send_queue_overflow_policy::drop_newest:
+          drop_send_entry(entry, send_status::dropped_send_queue_overflow, std::nullopt);
+          return false;
+
+        case send_queue_overflow_policy::drop_oldest: {
+          // Keep the entry which is being sent.
+          auto oldest = send_entries_->pop_oldest(sending_entry_.get());
+          if (!oldest) {
+            // There is no room even if all droppable entries are dropped.
+            drop_send_entry(entry, send_status::dropped_send_queue_overflow, std::nullopt);
+            return false;
+          }
+
+          drop_send_entry(oldest, send_status::dropped_send_queue_overflow, std::nullopt);
+          break;
+        }
+
+        case send_queue_overflow_policy::reject_with_error:
+          drop_send_entry(entry, send_status::dropped_send_queue_overflow, asio::error::no_buffer_space);
+          return false;
+      }
+    }
+
+    send_entries_->push_back(entry);
+
+    update_send_queue_watermark();
+
+    return true;
+  }
+
+  // This method is executed in `io_ctx_thread_`.
+  bool send_queue_full(size_t new_entry_size) const {
+    if (send_queue_max_entry_count_ &&
+        send_entries_->size() + 1 > *send_queue_max_entry_count_) {
+      return true;
+    }
+
+    if (send_queue_max_bytes_ &&
+        send_entries_->get_bytes() + new_entry_size > *send_queue_max_bytes_) {
+      return true;
     }
 
-    auto entry = send_entries_->front();
+    return false;
+  }
+
+  // Complete the entry which is not sent.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void drop_send_entry(not_null_shared_ptr_t<send_entry> entry,
+                       send_status status,
+                       std::optional<asio::error_code> error_code) {
+    if (error_code) {
+      enqueue_to_dispatcher([this, error_code] {
+        error_occurred(*error_code);
+      });
+    }
+
+    complete_send_entry(entry,
+                        status);
+  }
+
+  // Report `status` to futures of the entry and keep `processed` until `flush_completed_processed`.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void complete_send_entry(not_null_shared_ptr_t<send_entry> entry,
+                           send_status status) {
+    entry->complete(status);
+
     if (auto&& processed = entry->get_processed()) {
-      enqueue_to_dispatcher([processed] {
-        processed();
+      completed_processed_.push_back(processed);
+    }
+
+    entry->finish_batch_completions([this](auto&& processed) {
+      completed_processed_.push_back(std::move(processed));
+    });
+  }
+
+  // Call `processed` of entries which are completed in the current handler (e.g., a send batch) by a single dispatcher post.
+  // Handlers which complete entries call this method once at the end.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void flush_completed_processed() {
+    if (completed_processed_.empty()) {
+      return;
+    }
+
+    enqueue_to_dispatcher([callbacks = std::move(completed_processed_)] {
+      for (const auto& p : callbacks) {
+        p();
+      }
+    });
+    completed_processed_.clear();
+  }
+
+  // This method is executed in `io_ctx_thread_`.
+  void update_send_queue_watermark() {
+    // Tell the fast path only when the send queue becomes empty or non-empty.
+    if (send_queue_empty_ != send_entries_->empty()) {
+      send_queue_empty_ = send_entries_->empty();
+      send_fast_path_->set_queued(!send_queue_empty_);
+    }
+
+    if (!send_queue_high_watermark_) {
+      return;
+    }
+
+    auto size = send_entries_->size();
+
+    if (!send_queue_above_high_watermark_ &&
+        size >= *send_queue_high_watermark_) {
+      send_queue_above_high_watermark_ = true;
+
+      enqueue_to_dispatcher([this] {
+        send_queue_high_watermark();
       });
+
+    } else if (send_queue_above_high_watermark_ &&
+               size <= send_queue_low_watermark_) {
+      send_queue_above_high_watermark_ = false;
+
+      enqueue_to_dispatcher([this] {
+        send_queue_low_watermark();
+      });
+    }
+  }
+
+  // This method is executed in `io_ctx_thread_`.
+  void pop_send_entry(not_null_shared_ptr_t<send_entry> entry,
+                      send_status status) {
+    no_buffer_space_parked_ = false;
+
+    if (status == send_status::sent &&
+        (entry->get_type() == send_entry::type::user_data ||
+         entry->get_type() == send_entry::type::batch)) {
+      user_data_sent_ = true;
     }
 
-    send_entries_->pop_front();
+    complete_send_entry(entry,
+                        status);
+
+    send_entries_->pop(*entry);
+
+    update_send_queue_watermark();
+  }
+
+  static std::chrono::milliseconds no_buffer_space_retry_interval(size_t error_count) {
+    auto interval = no_buffer_space_minimum_retry_interval;
+    for (size_t i = 1; i < error_count && interval < no_buffer_space_maximum_retry_interval; ++i) {
+      interval *= 2;
+    }
+    return std::min(interval, no_buffer_space_maximum_retry_interval);
   }
 
   // This method is executed in `io_ctx_thread_`.
@@ -456,7 +1629,9 @@ protected:
 
   // External variables
   mode mode_;
-  not_null_shared_ptr_t<std::deque<not_null_shared_ptr_t<send_entry>>> send_entries_;
+  not_null_shared_ptr_t<send_queue> send_entries_;
+  not_null_shared_ptr_t<send_fast_path> send_fast_path_;
+  std::shared_ptr<send_handoff_queue> send_handoff_queue_;
 
   // asio
   asio::io_context io_ctx_;
@@ -464,16 +1639,71 @@ protected:
   std::thread io_ctx_thread_;
   std::unique_ptr<asio::local::datagram_protocol::socket> socket_;
   bool socket_ready_;
+  size_t buffer_size_;
 
   // Server
   std::filesystem::path bound_path_;
   std::vector<uint8_t> receive_buffer_;
   asio::local::datagram_protocol::endpoint receive_sender_endpoint_;
-  std::vector<not_null_shared_ptr_t<next_heartbeat_deadline_timer>> next_heartbeat_deadline_timers_;
-  std::atomic<uint64_t> next_heartbeat_deadline_timers_generation_{0};
+  endpoint_intern_table endpoint_intern_table_;
+  std::optional<size_t> receive_batch_size_;
+  size_t receive_buffer_pool_size_;
+  std::shared_ptr<receive_buffer_pool> receive_buffer_pool_;
+  std::function<void(std::span<const uint8_t> buffer,
+                     const asio::local::datagram_protocol::endpoint& sender_endpoint)>
+      inline_received_handler_;
+  std::shared_ptr<receive_channel> receive_channel_;
+  bool receive_paused_;
+  bool user_data_as_heartbeat_;
+  // Whether user data is sent after the last heartbeat. (client)
+  bool user_data_sent_;
+  // Whether the server confirms that it treats user data as a heartbeat by capabilities. (client)
+  bool peer_user_data_as_heartbeat_;
+  bool socket_file_watch_;
+  std::unique_ptr<socket_file_watcher> socket_file_watcher_;
+  // Whether the socket is being closed because the bound socket file is removed.
+  bool socket_file_removed_;
+#ifdef __linux__
+  std::vector<std::vector<uint8_t>> receive_batch_buffers_;
+  std::vector<asio::local::datagram_protocol::endpoint> receive_batch_sender_endpoints_;
+  std::vector<iovec> receive_batch_iovecs_;
+  std::vector<mmsghdr> receive_batch_headers_;
+#endif
+  next_heartbeat_deadline_wheel next_heartbeat_deadlines_;
+  // A single timer which drives `next_heartbeat_deadlines_`.
+  asio::steady_timer next_heartbeat_deadline_timer_;
+  std::optional<asio::steady_timer::time_point> next_heartbeat_deadline_timer_expiry_;
+  std::atomic<uint64_t> next_heartbeat_deadline_generation_{0};
 
   // Sender
-  asio::steady_timer send_invoker_;
+  std::optional<size_t> send_batch_size_;
+  // Entries which are taken from `send_entries_` to send next.
+  std::vector<not_null_shared_ptr_t<send_entry>> send_ready_entries_;
+  std::shared_ptr<send_entry> sending_entry_;
+#ifdef __linux__
+  std::vector<iovec> send_batch_iovecs_;
+  std::vector<mmsghdr> send_batch_headers_;
+#endif
+  // `processed` of completed entries which are not passed to the dispatcher yet.
+  std::vector<std::function<void()>> completed_processed_;
+  std::optional<size_t> send_queue_max_entry_count_;
+  std::optional<size_t> send_queue_max_bytes_;
+  send_queue_overflow_policy send_queue_overflow_policy_;
+  std::optional<size_t> send_queue_high_watermark_;
+  size_t send_queue_low_watermark_;
+  bool send_queue_above_high_watermark_;
+  size_t no_buffer_space_unsent_entry_retry_limit_;
+  size_t no_buffer_space_retry_limit_;
+  std::chrono::milliseconds send_deadline_duration_;
+  sender_state sender_state_;
+  bool waiting_writable_;
+  bool no_buffer_space_parked_;
+  // Whether `send_entries_` was empty when `send_fast_path_` is updated last time.
+  bool send_queue_empty_;
+  std::optional<std::chrono::microseconds> send_coalescing_linger_window_;
+  // The maximum batch size of peers which accept batches. (keyed by `send_queue::make_key`)
+  std::unordered_map<std::string, size_t, send_queue::key_hash, std::equal_to<>> peer_max_batch_sizes_;
+  asio::steady_timer send_retry_timer_;
   asio::steady_timer send_deadline_;
 };
 } // namespace pqrs::local_datagram::impl
@@ -9,6 +9,9 @@
 #include "asio_helper.hpp"
 #include "base_impl.hpp"
 #include "send_entry.hpp"
+#include "send_entry_pool.hpp"
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <deque>
 #include <filesystem>
@@ -29,18 +32,27 @@ public:
   client_impl(const client_impl&) = delete;
 
   client_impl(std::weak_ptr<dispatcher::dispatcher> weak_dispatcher,
-              not_null_shared_ptr_t<std::deque<not_null_shared_ptr_t<send_entry>>> send_entries)
+              not_null_shared_ptr_t<send_queue> send_entries,
+              not_null_shared_ptr_t<send_fast_path> send_fast_path)
       : base_impl(weak_dispatcher,
                   base_impl::mode::client,
-                  send_entries),
-        server_check_timer_(*this),
-        client_socket_check_timer_(*this),
-        client_socket_check_client_send_entries_(std::make_shared<std::deque<not_null_shared_ptr_t<impl::send_entry>>>()) {
+                  send_entries,
+                  send_fast_path),
+        server_check_timer_(io_ctx_, asio_helper::time_point::pos_infin()),
+        client_socket_check_timer_(io_ctx_, asio_helper::time_point::pos_infin()),
+        heartbeat_send_entry_pool_(std::make_shared<send_entry_pool>(sizeof(uint32_t),
+                                                                     heartbeat_send_entry_pool_size)) {
   }
 
   ~client_impl() {
     async_close();
 
+    // `server_check_timer_` and `client_socket_check_timer_` keep `io_ctx_` running until they are canceled.
+    asio::post(io_ctx_, [this] {
+      stop_server_check();
+      stop_client_socket_check();
+    });
+
     terminate_base_impl();
   }
 
@@ -120,7 +132,7 @@ public:
               });
             } else {
               socket_ready_ = true;
-              ++next_heartbeat_deadline_timers_generation_;
+              reset_next_heartbeat_deadlines();
 
               stop_server_check();
               start_server_check(server_check_interval,
@@ -154,25 +166,50 @@ public:
   }
 
 private:
+  // Heartbeats are sent one by one, so a few entries are enough unless sending is stalled.
+  static constexpr size_t heartbeat_send_entry_pool_size = 4;
+
+  // Heartbeats are sent by `server_check_timer_` in `io_ctx_thread_` without waking the dispatcher thread.
+  //
   // This method is executed in `io_ctx_thread_`.
   void start_server_check(std::optional<std::chrono::milliseconds> server_check_interval,
                           std::optional<std::chrono::milliseconds> next_heartbeat_deadline) {
     if (server_check_interval) {
-      server_check_timer_.start(
-          [this,
-           next_heartbeat_deadline] {
-            asio::post(io_ctx_, [this,
-                                 next_heartbeat_deadline] {
-              check_server(next_heartbeat_deadline);
-            });
-          },
-          *server_check_interval);
+      // The first heartbeat is sent immediately.
+      // (It is not skipped by user data sent in the previous connection.)
+      take_user_data_sent();
+
+      server_check_timer_.expires_at(asio_helper::time_point::now());
+      wait_server_check(*server_check_interval,
+                        next_heartbeat_deadline);
     }
   }
 
+  // This method is executed in `io_ctx_thread_`.
+  void wait_server_check(std::chrono::milliseconds server_check_interval,
+                         std::optional<std::chrono::milliseconds> next_heartbeat_deadline) {
+    server_check_timer_.async_wait(
+        [this,
+         server_check_interval,
+         next_heartbeat_deadline](const auto& error_code) {
+          if (error_code == asio::error::operation_aborted) {
+            return;
+          }
+
+          check_server(next_heartbeat_deadline);
+
+          if (socket_ &&
+              socket_ready_) {
+            server_check_timer_.expires_after(server_check_interval);
+            wait_server_check(server_check_interval,
+                              next_heartbeat_deadline);
+          }
+        });
+  }
+
   // This method is executed in `io_ctx_thread_`.
   void stop_server_check() {
-    server_check_timer_.stop();
+    server_check_timer_.cancel();
   }
 
   // This method is executed in `io_ctx_thread_`.
@@ -183,6 +220,13 @@ private:
       return;
     }
 
+    // The server treats the user data as a heartbeat.
+    if (take_user_data_sent() &&
+        user_data_as_heartbeat_ &&
+        peer_user_data_as_heartbeat_) {
+      return;
+    }
+
     // uint32_t is sufficient here because next_heartbeat_deadline is a wait time in milliseconds.
     // (e.g., 3000 milliseconds)
     // Values beyond ~49 days are not meaningful for this use case.
@@ -191,75 +235,95 @@ private:
       next_heartbeat_deadline_value = next_heartbeat_deadline->count();
     }
 
-    std::vector<uint8_t> v(sizeof(uint32_t));
+    std::array<uint8_t, sizeof(uint32_t)> v;
     std::memcpy(v.data(),
                 &next_heartbeat_deadline_value,
                 sizeof(next_heartbeat_deadline_value));
 
-    auto b = std::make_shared<send_entry>(send_entry::type::heartbeat,
-                                          v,
-                                          nullptr);
+    // The heartbeat is stored in the pooled entry in order to avoid heap allocation in every interval.
+    auto b = heartbeat_send_entry_pool_->copy_entry(send_entry::type::heartbeat,
+                                                    v,
+                                                    nullptr);
     async_send(b);
   }
 
+  // The socket file is checked by `client_socket_check_timer_` in `io_ctx_thread_` without waking the dispatcher thread.
+  //
   // This method is executed in `io_ctx_thread_`.
   void start_client_socket_check(std::optional<std::filesystem::path> client_socket_file_path,
                                  std::optional<std::chrono::milliseconds> client_socket_check_interval) {
-    if (client_socket_file_path &&
-        client_socket_check_interval) {
-      client_socket_check_timer_.start(
-          [this, client_socket_file_path] {
-            asio::post(io_ctx_, [this, client_socket_file_path] {
-              check_client_socket(*client_socket_file_path);
-            });
-          },
-          *client_socket_check_interval);
+    if (!client_socket_file_path) {
+      return;
+    }
+
+    if (client_socket_check_interval ||
+        socket_file_watch_) {
+      // The probe remembers the bound file.
+      client_socket_check_probe_ = std::make_unique<socket_file_probe>(*client_socket_file_path);
+    }
+
+    if (socket_file_watch_) {
+      socket_file_watcher_ = std::make_unique<socket_file_watcher>(io_ctx_,
+                                                                   *client_socket_file_path,
+                                                                   [this] {
+                                                                     check_client_socket();
+                                                                   });
+    }
+
+    // The polling check is also used as a fallback of the watcher.
+    // (It is lengthened while the watcher is available.)
+    if (client_socket_check_interval) {
+      auto interval = *client_socket_check_interval;
+      if (socket_file_watcher_ &&
+          socket_file_watcher_->watching()) {
+        interval = std::max(interval, watched_socket_file_check_interval);
+      }
+
+      client_socket_check_timer_.expires_at(asio_helper::time_point::now());
+      wait_client_socket_check(interval);
     }
   }
 
+  // This method is executed in `io_ctx_thread_`.
+  void wait_client_socket_check(std::chrono::milliseconds client_socket_check_interval) {
+    client_socket_check_timer_.async_wait(
+        [this,
+         client_socket_check_interval](const auto& error_code) {
+          if (error_code == asio::error::operation_aborted) {
+            return;
+          }
+
+          check_client_socket();
+
+          if (client_socket_check_probe_) {
+            client_socket_check_timer_.expires_after(client_socket_check_interval);
+            wait_client_socket_check(client_socket_check_interval);
+          }
+        });
+  }
+
   // This method is executed in `io_ctx_thread_`.
   void stop_client_socket_check() {
-    client_socket_check_timer_.stop();
-    client_socket_check_client_impl_ = nullptr;
+    client_socket_check_timer_.cancel();
+    client_socket_check_probe_ = nullptr;
+    socket_file_watcher_ = nullptr;
   }
 
   // This method is executed in `io_ctx_thread_`.
-  void check_client_socket(const std::filesystem::path& client_socket_file_path) {
+  void check_client_socket() {
     if (!socket_ ||
-        !socket_ready_) {
+        !socket_ready_ ||
+        !client_socket_check_probe_) {
       stop_client_socket_check();
       return;
     }
 
-    if (!client_socket_check_client_impl_) {
-      client_socket_check_client_impl_ = std::make_unique<client_impl>(
-          weak_dispatcher_,
-          client_socket_check_client_send_entries_);
-
-      client_socket_check_client_impl_->connected.connect([this](auto&& peer_pid) {
-        asio::post(io_ctx_, [this] {
-          client_socket_check_client_impl_ = nullptr;
-        });
-      });
-
-      client_socket_check_client_impl_->connect_failed.connect([this](auto&& error_code) {
-        async_close();
-      });
-
-      size_t buffer_size = 32;
-      client_socket_check_client_impl_->async_connect(client_socket_file_path,
-                                                      std::nullopt, // client_socket_file_path
-                                                      buffer_size,
-                                                      std::nullopt, // server_check_interval
-                                                      std::nullopt, // next_heartbeat_deadline
-                                                      std::nullopt  // client_socket_check_interval
-      );
-    }
+    check_socket_file(*client_socket_check_probe_);
   }
 
-  dispatcher::extra::timer server_check_timer_;
-  dispatcher::extra::timer client_socket_check_timer_;
-  std::unique_ptr<client_impl> client_socket_check_client_impl_;
-  not_null_shared_ptr_t<std::deque<not_null_shared_ptr_t<send_entry>>> client_socket_check_client_send_entries_;
+  asio::steady_timer server_check_timer_;
+  asio::steady_timer client_socket_check_timer_;
+  std::unique_ptr<socket_file_probe> client_socket_check_probe_;
+  not_null_shared_ptr_t<send_entry_pool> heartbeat_send_entry_pool_;
 };
 } // namespace pqrs::local_datagram::impl
@@ -0,0 +1,112 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::local_datagram::impl::endpoint_intern_table` cannot be used safely in a multi-threaded environment.
+// (It is owned by `io_ctx_thread_`.)
+
+#include "asio_helper.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <pqrs/gsl.hpp>
+#include <string>
+#include <string_view>
+#include <sys/un.h>
+#include <unordered_map>
+
+namespace pqrs::local_datagram::impl {
+class endpoint_intern_table final {
+public:
+  using endpoint_id = uint64_t;
+
+  class entry final {
+  public:
+    entry(endpoint_id id,
+          not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint> endpoint)
+        : id_(id),
+          endpoint_(endpoint) {
+    }
+
+    [[nodiscard]] endpoint_id get_id() const {
+      return id_;
+    }
+
+    [[nodiscard]] const not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint>& get_endpoint() const {
+      return endpoint_;
+    }
+
+  private:
+    endpoint_id id_;
+    not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint> endpoint_;
+  };
+
+  endpoint_intern_table()
+      : last_id_(0),
+        sweep_threshold_(minimum_sweep_threshold) {
+  }
+
+  // Returns the entry which holds the endpoint equal to `endpoint`.
+  // The same `entry` (the same id and the same endpoint instance) is returned for the same endpoint
+  // while the endpoint is referenced from outside of the table.
+  const entry& intern(const asio::local::datagram_protocol::endpoint& endpoint) {
+    auto key = make_key(endpoint);
+
+    if (auto it = entries_.find(key); it != std::end(entries_)) {
+      return it->second;
+    }
+
+    if (entries_.size() >= sweep_threshold_) {
+      sweep();
+    }
+
+    auto [it, inserted] = entries_.try_emplace(std::string(key),
+                                               ++last_id_,
+                                               std::make_shared<asio::local::datagram_protocol::endpoint>(endpoint));
+    return it->second;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return entries_.size();
+  }
+
+private:
+  static constexpr size_t minimum_sweep_threshold = 64;
+
+  struct key_hash final {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view value) const {
+      return std::hash<std::string_view>{}(value);
+    }
+  };
+
+  // Use `sun_path` bytes as a key in order to avoid `endpoint::path()` which creates `std::string`.
+  static std::string_view make_key(const asio::local::datagram_protocol::endpoint& endpoint) {
+    auto offset = offsetof(sockaddr_un, sun_path);
+    if (endpoint.size() <= offset) {
+      return std::string_view();
+    }
+
+    return std::string_view(reinterpret_cast<const char*>(endpoint.data()) + offset,
+                            endpoint.size() - offset);
+  }
+
+  // Remove endpoints which are referenced only from the table.
+  void sweep() {
+    std::erase_if(entries_, [](const auto& pair) {
+      return pair.second.get_endpoint().get().use_count() == 1;
+    });
+
+    sweep_threshold_ = std::max(minimum_sweep_threshold,
+                                entries_.size() * 2);
+  }
+
+  std::unordered_map<std::string, entry, key_hash, std::equal_to<>> entries_;
+  endpoint_id last_id_;
+  size_t sweep_threshold_;
+};
+} // namespace pqrs::local_datagram::impl
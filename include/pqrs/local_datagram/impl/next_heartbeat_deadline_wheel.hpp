@@ -0,0 +1,269 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::local_datagram::impl::next_heartbeat_deadline_wheel` cannot be used safely in a multi-threaded environment.
+
+#include "asio_helper.hpp"
+#include "endpoint_intern_table.hpp"
+#include <array>
+#include <list>
+#include <optional>
+#include <pqrs/gsl.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace pqrs::local_datagram::impl {
+
+// A hierarchical timer wheel which tracks the next heartbeat deadline of each sender endpoint.
+//
+// - Deadlines are indexed by `endpoint_id`, so `set` and `erase` are O(1).
+// - `advance` expires deadlines with one wakeup for all endpoints.
+// - Deadlines are rounded up to `tick`.
+class next_heartbeat_deadline_wheel final {
+public:
+  static constexpr std::chrono::milliseconds default_tick{10};
+
+  next_heartbeat_deadline_wheel(const next_heartbeat_deadline_wheel&) = delete;
+
+  next_heartbeat_deadline_wheel(std::chrono::milliseconds tick = default_tick)
+      : tick_(std::max(tick, std::chrono::milliseconds(1))),
+        origin_(asio_helper::time_point::now()),
+        current_tick_(0) {
+  }
+
+  [[nodiscard]] bool empty() const {
+    return entries_.empty();
+  }
+
+  [[nodiscard]] size_t size() const {
+    return entries_.size();
+  }
+
+  [[nodiscard]] bool contains(endpoint_intern_table::endpoint_id id) const {
+    return entries_.contains(id);
+  }
+
+  // Set (or reset) the deadline of `sender_endpoint`.
+  // `next_heartbeat_deadline` is used by `refresh`.
+  void set(endpoint_intern_table::endpoint_id id,
+           not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint> sender_endpoint,
+           asio::steady_timer::time_point deadline,
+           std::chrono::milliseconds next_heartbeat_deadline) {
+    auto expiry_tick = to_tick(deadline, rounding::up);
+
+    auto it = entries_.find(id);
+    if (it == std::end(entries_)) {
+      // Append the id into the slot of the next tick at first, then `place` moves it into the correct slot.
+      auto& s = slot_at(0, current_tick_ + 1);
+      s.push_back(id);
+
+      it = entries_.try_emplace(id,
+                                entry{sender_endpoint,
+                                      next_heartbeat_deadline,
+                                      expiry_tick,
+                                      &s,
+                                      std::prev(std::end(s))})
+               .first;
+    } else {
+      it->second.sender_endpoint = sender_endpoint;
+      it->second.next_heartbeat_deadline = next_heartbeat_deadline;
+      it->second.expiry_tick = expiry_tick;
+    }
+
+    place(it->second);
+  }
+
+  // Extend the deadline to `now` + the last `next_heartbeat_deadline` if `id` has an active deadline.
+  // Returns the new deadline.
+  std::optional<asio::steady_timer::time_point> refresh(endpoint_intern_table::endpoint_id id,
+                                                        asio::steady_timer::time_point now) {
+    auto it = entries_.find(id);
+    if (it == std::end(entries_)) {
+      return std::nullopt;
+    }
+
+    auto deadline = now + it->second.next_heartbeat_deadline;
+    it->second.expiry_tick = to_tick(deadline, rounding::up);
+    place(it->second);
+
+    return deadline;
+  }
+
+  void erase(endpoint_intern_table::endpoint_id id) {
+    auto it = entries_.find(id);
+    if (it == std::end(entries_)) {
+      return;
+    }
+
+    it->second.slot->erase(it->second.position);
+    entries_.erase(it);
+  }
+
+  void clear() {
+    for (auto&& level : levels_) {
+      for (auto&& s : level) {
+        s.clear();
+      }
+    }
+    entries_.clear();
+  }
+
+  // Expire deadlines which are passed at `now` and call `f(sender_endpoint)` for each expired endpoint.
+  template <typename F>
+  void advance(asio::steady_timer::time_point now,
+               F&& f) {
+    auto now_tick = to_tick(now, rounding::down);
+
+    if (entries_.empty()) {
+      current_tick_ = std::max(current_tick_, now_tick);
+      return;
+    }
+
+    std::vector<not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint>> expired;
+
+    while (current_tick_ < now_tick) {
+      ++current_tick_;
+
+      // Move entries in the upper level slot into lower levels when the lower level wraps around.
+      for (size_t level = 1; level < level_count; ++level) {
+        if ((current_tick_ & (slot_count_at(level - 1) - 1)) != 0) {
+          break;
+        }
+
+        auto& s = slot_at(level, current_tick_);
+        for (auto id_it = std::begin(s); id_it != std::end(s);) {
+          auto& e = entries_.at(*id_it);
+          ++id_it;
+          place(e);
+        }
+      }
+
+      auto& s = slot_at(0, current_tick_);
+      while (!s.empty()) {
+        auto it = entries_.find(s.front());
+        expired.push_back(it->second.sender_endpoint);
+        s.pop_front();
+        entries_.erase(it);
+      }
+
+      if (entries_.empty()) {
+        current_tick_ = now_tick;
+        break;
+      }
+    }
+
+    for (const auto& e : expired) {
+      f(e);
+    }
+  }
+
+  // Returns the time when `advance` should be called next.
+  // (It might be earlier than the next deadline when entries are moved between levels.)
+  [[nodiscard]] std::optional<asio::steady_timer::time_point> get_next_advance_time() const {
+    if (entries_.empty()) {
+      return std::nullopt;
+    }
+
+    std::optional<uint64_t> result;
+
+    for (size_t level = 0; level < level_count; ++level) {
+      auto shift = slot_bits * level;
+      auto base = current_tick_ >> shift;
+
+      for (uint64_t i = 1; i <= slot_count; ++i) {
+        if (!levels_[level][(base + i) & slot_mask].empty()) {
+          auto t = (base + i) << shift;
+          if (!result || t < *result) {
+            result = t;
+          }
+          break;
+        }
+      }
+    }
+
+    return to_time_point(result.value_or(current_tick_ + 1));
+  }
+
+private:
+  static constexpr size_t slot_bits = 6;
+  static constexpr uint64_t slot_count = 1 << slot_bits;
+  static constexpr uint64_t slot_mask = slot_count - 1;
+  static constexpr size_t level_count = 4;
+
+  using slot_list = std::list<endpoint_intern_table::endpoint_id>;
+
+  struct entry final {
+    not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint> sender_endpoint;
+    std::chrono::milliseconds next_heartbeat_deadline;
+    uint64_t expiry_tick;
+    slot_list* slot;
+    slot_list::iterator position;
+  };
+
+  // Returns the number of ticks which are covered by all slots in `level`.
+  static constexpr uint64_t slot_count_at(size_t level) {
+    return uint64_t(1) << (slot_bits * (level + 1));
+  }
+
+  slot_list& slot_at(size_t level,
+                     uint64_t tick) {
+    return levels_[level][(tick >> (slot_bits * level)) & slot_mask];
+  }
+
+  // Move the entry into the slot which matches its expiry tick.
+  void place(entry& e) {
+    auto expiry_tick = std::max(e.expiry_tick, current_tick_ + 1);
+    expiry_tick = std::min(expiry_tick, current_tick_ + slot_count_at(level_count - 1) - 1);
+
+    auto delta = expiry_tick - current_tick_;
+
+    size_t level = 0;
+    while (level < level_count - 1 &&
+           delta >= slot_count_at(level)) {
+      ++level;
+    }
+
+    auto& s = slot_at(level, expiry_tick);
+
+    // `splice` moves the id without allocation.
+    s.splice(std::end(s),
+             *e.slot,
+             e.position);
+    e.slot = &s;
+  }
+
+  enum class rounding {
+    // Deadlines are rounded up in order not to expire them early.
+    up,
+    down,
+  };
+
+  uint64_t to_tick(asio::steady_timer::time_point time_point,
+                   rounding r) const {
+    if (time_point <= origin_) {
+      return 0;
+    }
+
+    if (r == rounding::up) {
+      auto duration = std::chrono::ceil<std::chrono::milliseconds>(time_point - origin_);
+      return (duration.count() + tick_.count() - 1) / tick_.count();
+    }
+
+    auto duration = std::chrono::floor<std::chrono::milliseconds>(time_point - origin_);
+    return duration.count() / tick_.count();
+  }
+
+  asio::steady_timer::time_point to_time_point(uint64_t tick) const {
+    return origin_ + tick * tick_;
+  }
+
+  std::chrono::milliseconds tick_;
+  asio::steady_timer::time_point origin_;
+  uint64_t current_tick_;
+  std::array<std::array<slot_list, slot_count>, level_count> levels_;
+  std::unordered_map<endpoint_intern_table::endpoint_id, entry> entries_;
+};
+} // namespace pqrs::local_datagram::impl
@@ -0,0 +1,161 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::local_datagram::impl::receive_buffer_pool` can be used safely in a multi-threaded environment.
+// (`lease` must be called from a single thread. Leased buffers can be released from any thread.)
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <pqrs/gsl.hpp>
+#include <span>
+#include <vector>
+
+namespace pqrs::local_datagram::impl {
+class receive_buffer_pool final : public std::enable_shared_from_this<receive_buffer_pool> {
+public:
+  receive_buffer_pool(const receive_buffer_pool&) = delete;
+
+  // `capacity` is the buffer size of each slab.
+  // `max_slab_count` is the maximum number of slabs. `lease` falls back to a heap allocated buffer when all slabs are in use.
+  receive_buffer_pool(size_t capacity,
+                      size_t max_slab_count)
+      : capacity_(capacity),
+        max_slab_count_(max_slab_count),
+        free_slabs_(nullptr),
+        returned_slabs_(nullptr) {
+  }
+
+  // Returns a buffer which holds a copy of `data`.
+  // The slab is returned to the pool when the last reference of the buffer is dropped.
+  //
+  // This method must be called from a single thread. (`io_ctx_thread_`)
+  [[nodiscard]] not_null_shared_ptr_t<std::vector<uint8_t>> lease(std::span<const uint8_t> data) {
+    auto s = pop_free_slab();
+    if (!s) {
+      return std::make_shared<std::vector<uint8_t>>(std::begin(data),
+                                                    std::end(data));
+    }
+
+    s->buffer.assign(std::begin(data),
+                     std::end(data));
+
+    return std::shared_ptr<std::vector<uint8_t>>(&(s->buffer),
+                                                 [](auto&&) {
+                                                   // The buffer is owned by the slab.
+                                                 },
+                                                 slab_allocator<std::vector<uint8_t>>(shared_from_this(), s));
+  }
+
+  [[nodiscard]] size_t get_slab_count() const {
+    return slabs_.size();
+  }
+
+private:
+  struct slab final {
+    std::vector<uint8_t> buffer;
+
+    // The control block of `std::shared_ptr` is also placed in the slab in order to avoid heap allocation.
+    alignas(std::max_align_t) std::byte control_block[128];
+
+    slab* next = nullptr;
+  };
+
+  // An allocator which places the `std::shared_ptr` control block in the slab,
+  // and returns the slab to the pool when the control block is deallocated.
+  template <typename T>
+  class slab_allocator final {
+  public:
+    using value_type = T;
+
+    slab_allocator(std::shared_ptr<receive_buffer_pool> pool,
+                   slab* s)
+        : pool_(pool),
+          slab_(s) {
+    }
+
+    template <typename U>
+    slab_allocator(const slab_allocator<U>& other)
+        : pool_(other.pool_),
+          slab_(other.slab_) {
+    }
+
+    [[nodiscard]] T* allocate(size_t n) {
+      if (sizeof(T) * n <= sizeof(slab_->control_block) &&
+          alignof(T) <= alignof(std::max_align_t)) {
+        return reinterpret_cast<T*>(slab_->control_block);
+      }
+
+      return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+      if (reinterpret_cast<std::byte*>(p) != slab_->control_block) {
+        std::allocator<T>().deallocate(p, n);
+      }
+
+      // The control block is no longer used at this point.
+      pool_->push_free_slab(slab_);
+    }
+
+    template <typename U>
+    bool operator==(const slab_allocator<U>& other) const {
+      return slab_ == other.slab_;
+    }
+
+  private:
+    template <typename U>
+    friend class slab_allocator;
+
+    std::shared_ptr<receive_buffer_pool> pool_;
+    slab* slab_;
+  };
+
+  // This method is executed in the lease thread.
+  slab* pop_free_slab() {
+    if (!free_slabs_) {
+      // Take all returned slabs at once.
+      free_slabs_ = returned_slabs_.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    if (free_slabs_) {
+      auto s = free_slabs_;
+      free_slabs_ = s->next;
+      s->next = nullptr;
+      return s;
+    }
+
+    if (slabs_.size() < max_slab_count_) {
+      auto s = std::make_unique<slab>();
+      s->buffer.reserve(capacity_);
+      slabs_.push_back(std::move(s));
+      return slabs_.back().get();
+    }
+
+    return nullptr;
+  }
+
+  // This method can be called from any thread.
+  void push_free_slab(slab* s) {
+    s->next = returned_slabs_.load(std::memory_order_relaxed);
+    while (!returned_slabs_.compare_exchange_weak(s->next,
+                                                  s,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+    }
+  }
+
+  size_t capacity_;
+  size_t max_slab_count_;
+  std::vector<std::unique_ptr<slab>> slabs_;
+
+  // Slabs which are owned by the lease thread.
+  slab* free_slabs_;
+
+  // Lock-free stack of returned slabs.
+  std::atomic<slab*> returned_slabs_;
+};
+} // namespace pqrs::local_datagram::impl
@@ -0,0 +1,188 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::local_datagram::impl::receive_channel` can be used safely in a multi-threaded environment.
+
+#include "../received_datagram.hpp"
+#include "asio_helper.hpp"
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <pqrs/gsl.hpp>
+
+namespace pqrs::local_datagram::impl {
+
+// A queue which passes received user data from `io_ctx_thread_` to `async_receive` callers.
+//
+// The receiver stops reading the socket while the queue holds `capacity` datagrams.
+// Thus, the sender is blocked by the socket buffer if the consumer does not call `async_receive`.
+class receive_channel final {
+public:
+  using signature = void(asio::error_code, received_datagram);
+
+  receive_channel(const receive_channel&) = delete;
+
+  receive_channel()
+      : capacity_(1),
+        closed_(false) {
+  }
+
+  ~receive_channel() {
+    close();
+  }
+
+  void set_capacity(size_t value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    capacity_ = std::max(value, size_t(1));
+  }
+
+  // Pass `datagram` to the waiting handler or append it into the queue.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void push(received_datagram datagram) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (handler_) {
+      auto h = std::move(*handler_);
+      handler_ = std::nullopt;
+
+      lock.unlock();
+
+      complete_later(std::move(h),
+                     asio::error_code(),
+                     std::move(datagram));
+      return;
+    }
+
+    datagrams_.push_back(std::move(datagram));
+  }
+
+  // Returns true if the queue has room.
+  // Otherwise, `resume` is called when the queue gets room and returns false.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  bool wait_for_room(std::function<void()> resume) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (datagrams_.size() < capacity_) {
+      return true;
+    }
+
+    resume_ = resume;
+    return false;
+  }
+
+  // `resume` which is passed to `wait_for_room` is never called after `cancel_resume` returns.
+  void cancel_resume() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    resume_ = nullptr;
+  }
+
+  // Receive a datagram.
+  // The completion signature is `void(asio::error_code, received_datagram)`.
+  // `asio::error::operation_aborted` is reported when the client or server is destroyed.
+  //
+  // Only one `async_receive` can be outstanding at a time.
+  // `asio::error::in_progress` is reported to the second call while the first call is waiting.
+  template <typename CompletionToken>
+  auto async_receive(CompletionToken&& token) {
+    return asio::async_initiate<CompletionToken, signature>(
+        [this](auto handler) {
+          std::unique_lock<std::mutex> lock(mutex_);
+
+          if (closed_) {
+            lock.unlock();
+            complete_later(std::move(handler),
+                           asio::error::operation_aborted,
+                           make_empty_datagram());
+            return;
+          }
+
+          if (handler_) {
+            lock.unlock();
+            complete_later(std::move(handler),
+                           asio::error::in_progress,
+                           make_empty_datagram());
+            return;
+          }
+
+          if (datagrams_.empty()) {
+            handler_ = std::move(handler);
+            return;
+          }
+
+          auto datagram = std::move(datagrams_.front());
+          datagrams_.pop_front();
+
+          // Resume receiving since the queue gets room.
+          if (resume_) {
+            resume_();
+            resume_ = nullptr;
+          }
+
+          lock.unlock();
+
+          complete_later(std::move(handler),
+                         asio::error_code(),
+                         std::move(datagram));
+        },
+        token);
+  }
+
+  // Abort the waiting handler.
+  void close() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    closed_ = true;
+    resume_ = nullptr;
+
+    if (handler_) {
+      auto h = std::move(*handler_);
+      handler_ = std::nullopt;
+
+      lock.unlock();
+
+      complete_later(std::move(h),
+                     asio::error::operation_aborted,
+                     make_empty_datagram());
+    }
+  }
+
+private:
+  // The handler is called in its associated executor. (e.g., the executor of the coroutine)
+  // It is called in asio's system executor if no executor is associated.
+  // (The handler is never called in the initiating function.)
+  template <typename Handler>
+  static void complete_later(Handler&& handler,
+                             asio::error_code error_code,
+                             received_datagram datagram) {
+    auto executor = asio::prefer(asio::get_associated_executor(handler),
+                                 asio::execution::blocking.never);
+    executor.execute([handler = std::forward<Handler>(handler),
+                      error_code,
+                      datagram = std::move(datagram)]() mutable {
+      std::move(handler)(error_code,
+                         std::move(datagram));
+    });
+  }
+
+  static received_datagram make_empty_datagram() {
+    return received_datagram(std::make_shared<std::vector<uint8_t>>(),
+                             std::make_shared<asio::local::datagram_protocol::endpoint>());
+  }
+
+  size_t capacity_;
+  std::mutex mutex_;
+  std::deque<received_datagram> datagrams_;
+  std::optional<asio::any_completion_handler<signature>> handler_;
+  std::function<void()> resume_;
+  bool closed_;
+};
+} // namespace pqrs::local_datagram::impl
@@ -0,0 +1,40 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::local_datagram::impl::send_batch_completion` can be used safely in a multi-threaded environment.
+
+#include <atomic>
+#include <functional>
+
+namespace pqrs::local_datagram::impl {
+
+// Tracks entries which are sent by `async_send_batch`, and hands out `processed` once when all entries are finished.
+//
+// Entries are usually finished in `io_ctx_thread_`,
+// but orphaned entries are finished in the producer thread, so the counter is atomic.
+class send_batch_completion final {
+public:
+  send_batch_completion(const send_batch_completion&) = delete;
+
+  send_batch_completion(size_t count,
+                        std::function<void()> processed)
+      : remaining_(count),
+        processed_(processed) {
+  }
+
+  // Returns `processed` when the last entry is finished. Otherwise, returns nullptr.
+  std::function<void()> finish_entry() {
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      return std::move(processed_);
+    }
+    return nullptr;
+  }
+
+private:
+  std::atomic<size_t> remaining_;
+  std::function<void()> processed_;
+};
+} // namespace pqrs::local_datagram::impl
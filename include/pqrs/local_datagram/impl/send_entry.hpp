@@ -6,12 +6,27 @@
 
 // `pqrs::local_datagram::impl::send_entry` can be used safely in a multi-threaded environment.
 
+#include "../send_status.hpp"
 #include "asio_helper.hpp"
+#include "send_batch_completion.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
 #include <optional>
+#include <pqrs/gsl.hpp>
+#include <span>
 #include <vector>
 
 namespace pqrs::local_datagram::impl {
+class send_handoff_queue;
+
 class send_entry final {
+  friend class send_handoff_queue;
+
 public:
   // Sending empty data causes `No buffer space available` error after wake up on macOS.
   // We append `type` into the beginning of data in order to avoid this issue.
@@ -29,50 +44,147 @@ public:
   // - user_data
   //   |type (uint8_t)|
   //   |user specific data (variable length)| *optional
+  //
+  //
+  // - batch
+  //   |type (uint8_t)|
+  //   |length (uint16_t)|user specific data (variable length)|
+  //   |length (uint16_t)|user specific data (variable length)|
+  //   ...
+  //
+  //   Several user data are coalesced into one datagram.
+  //   The batch is sent only to peers which accept it by capabilities.
+  //
+  //
+  // - capabilities
+  //   |type (uint8_t)|
+  //   |reply requested (uint8_t)|
+  //   |maximum batch size (uint32_t)|
+  //   |flags (uint8_t)| *optional
+  //
+  //   The peer can send the batch which size <= the maximum batch size to the sender.
+  //   (The maximum batch size == 0 means the sender does not accept the batch.)
+  //   The receiver sends its capabilities to the sender if the reply is requested.
+  //   Old peers ignore capabilities, so batches are never sent to them.
+  //
+  //   flags:
+  //   - capability_flag_user_data_as_heartbeat: The sender treats user data as a heartbeat.
+  //     (The client skips heartbeats only when the server sends this flag.)
 
   enum class type : uint8_t {
     heartbeat,
     user_data,
+    batch,
+    capabilities,
   };
 
+  using batch_message_length_t = uint16_t;
+
+  static constexpr uint8_t capability_flag_user_data_as_heartbeat = 0x01;
+
+  send_entry(const send_entry&) = delete;
+
   send_entry(type t,
-             std::shared_ptr<asio::local::datagram_protocol::endpoint> destination_endpoint,
+             std::shared_ptr<const asio::local::datagram_protocol::endpoint> destination_endpoint,
              std::function<void()> processed = nullptr)
       : destination_endpoint_(destination_endpoint),
         processed_(processed),
         bytes_transferred_(0),
         no_buffer_space_error_count_(0),
-        buffer_{static_cast<uint8_t>(t)} {
+        header_(static_cast<uint8_t>(t)),
+        handoff_next_(nullptr) {
   }
 
   send_entry(type t,
              const std::vector<uint8_t>& v,
-             std::shared_ptr<asio::local::datagram_protocol::endpoint> destination_endpoint,
+             std::shared_ptr<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+             std::function<void()> processed = nullptr)
+      : destination_endpoint_(destination_endpoint),
+        processed_(processed),
+        bytes_transferred_(0),
+        no_buffer_space_error_count_(0),
+        header_(static_cast<uint8_t>(t)),
+        payload_storage_(v),
+        payload_(payload_storage_),
+        handoff_next_(nullptr) {
+  }
+
+  // The payload is moved into the entry without copying.
+  send_entry(type t,
+             std::vector<uint8_t>&& v,
+             std::shared_ptr<const asio::local::datagram_protocol::endpoint> destination_endpoint,
              std::function<void()> processed = nullptr)
       : destination_endpoint_(destination_endpoint),
         processed_(processed),
         bytes_transferred_(0),
         no_buffer_space_error_count_(0),
-        buffer_{static_cast<uint8_t>(t)} {
-    buffer_.insert(buffer_.end(), v.begin(), v.end());
+        header_(static_cast<uint8_t>(t)),
+        payload_storage_(std::move(v)),
+        payload_(payload_storage_),
+        handoff_next_(nullptr) {
   }
 
   send_entry(type t,
              const uint8_t* p,
              size_t length,
-             std::shared_ptr<asio::local::datagram_protocol::endpoint> destination_endpoint,
+             std::shared_ptr<const asio::local::datagram_protocol::endpoint> destination_endpoint,
              std::function<void()> processed = nullptr)
       : destination_endpoint_(destination_endpoint),
         processed_(processed),
         bytes_transferred_(0),
         no_buffer_space_error_count_(0),
-        buffer_{static_cast<uint8_t>(t)} {
+        header_(static_cast<uint8_t>(t)),
+        handoff_next_(nullptr) {
     if (p && length > 0) {
-      buffer_.insert(buffer_.end(), p, p + length);
+      payload_storage_.assign(p, p + length);
+      payload_ = payload_storage_;
     }
   }
 
-  [[nodiscard]] std::shared_ptr<asio::local::datagram_protocol::endpoint> get_destination_endpoint() const {
+  // The entry refers to the caller-owned `payload` without copying.
+  // `payload_owner` keeps `payload` alive until the entry is destroyed.
+  // (Use a `std::shared_ptr` with a custom deleter to be notified the release of `payload`.)
+  send_entry(type t,
+             std::span<const uint8_t> payload,
+             std::shared_ptr<const void> payload_owner,
+             std::shared_ptr<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+             std::function<void()> processed = nullptr)
+      : destination_endpoint_(destination_endpoint),
+        processed_(processed),
+        bytes_transferred_(0),
+        no_buffer_space_error_count_(0),
+        header_(static_cast<uint8_t>(t)),
+        payload_owner_(payload_owner),
+        payload_(payload),
+        handoff_next_(nullptr) {
+  }
+
+  // The entry shares `v` without copying.
+  send_entry(type t,
+             not_null_shared_ptr_t<const std::vector<uint8_t>> v,
+             std::shared_ptr<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+             std::function<void()> processed = nullptr)
+      : send_entry(t,
+                   std::span<const uint8_t>(*v),
+                   unwrap_not_null(v),
+                   destination_endpoint,
+                   processed) {
+  }
+
+  ~send_entry() {
+    // The entry is destroyed without sending. (e.g., the client is destroyed.)
+    complete(send_status::closed);
+  }
+
+  [[nodiscard]] type get_type() const {
+    return type(header_);
+  }
+
+  [[nodiscard]] std::span<const uint8_t> get_payload() const {
+    return payload_;
+  }
+
+  [[nodiscard]] std::shared_ptr<const asio::local::datagram_protocol::endpoint> get_destination_endpoint() const {
     return destination_endpoint_;
   }
 
@@ -80,6 +192,60 @@ public:
     return processed_;
   }
 
+  // `completion` is notified when the entry is finished. (`async_send_batch`)
+  // `add_batch_completion` has to be called before the entry is passed to `io_ctx_thread_`.
+  void add_batch_completion(not_null_shared_ptr_t<send_batch_completion> completion) {
+    if (!batch_completion_) {
+      batch_completion_ = completion;
+    } else {
+      extra_batch_completions_.push_back(completion);
+    }
+  }
+
+  // Call `f` with `processed` of batches which are finished by this entry.
+  template <typename F>
+  void finish_batch_completions(F&& f) {
+    if (batch_completion_) {
+      if (auto processed = batch_completion_->finish_entry()) {
+        f(std::move(processed));
+      }
+      batch_completion_ = nullptr;
+    }
+
+    for (const auto& c : extra_batch_completions_) {
+      if (auto processed = c->finish_entry()) {
+        f(std::move(processed));
+      }
+    }
+    extra_batch_completions_.clear();
+  }
+
+  // Returns a future which receives the status when the entry is completed.
+  // `make_future` has to be called before the entry is passed to `io_ctx_thread_`.
+  [[nodiscard]] std::future<send_status> make_future() {
+    return promises_.emplace_back().get_future();
+  }
+
+  // `handler` is called with the status in its associated executor when the entry is completed.
+  // `add_completion_handler` has to be called before the entry is passed to `io_ctx_thread_`.
+  void add_completion_handler(asio::any_completion_handler<void(send_status)> handler) {
+    completion_handlers_.push_back(std::move(handler));
+  }
+
+  // Report `status` to futures which are returned by `make_future` and completion handlers.
+  void complete(send_status status) {
+    for (auto&& p : promises_) {
+      p.set_value(status);
+    }
+    promises_.clear();
+
+    for (auto&& h : completion_handlers_) {
+      asio::dispatch(asio::append(std::move(h),
+                                  status));
+    }
+    completion_handlers_.clear();
+  }
+
   [[nodiscard]] size_t get_bytes_transferred() const {
     return bytes_transferred_;
   }
@@ -92,14 +258,100 @@ public:
     no_buffer_space_error_count_ = value;
   }
 
-  [[nodiscard]] asio::const_buffer make_buffer() const {
-    if (bytes_transferred_ >= buffer_.size()) {
-      return asio::const_buffer();
+  // The entry is dropped without sending if the entry is not sent until the deadline.
+  [[nodiscard]] std::optional<asio::steady_timer::time_point> get_deadline() const {
+    return deadline_;
+  }
+
+  void set_deadline(std::optional<asio::steady_timer::time_point> value) {
+    deadline_ = value;
+  }
+
+  [[nodiscard]] bool expired(asio::steady_timer::time_point now) const {
+    return deadline_ &&
+           *deadline_ <= now &&
+           bytes_transferred_ == 0;
+  }
+
+  // Returns the size of the batch when `message` is appended into the batch.
+  [[nodiscard]] static size_t batch_message_size(std::span<const uint8_t> message) {
+    return sizeof(batch_message_length_t) + message.size();
+  }
+
+  // Append `message` into the batch.
+  // `processed` is called when the batch is processed.
+  //
+  // The caller has to ensure `message.size()` <= the maximum value of `batch_message_length_t`.
+  void append_batch_message(std::span<const uint8_t> message,
+                            std::function<void()> processed) {
+    auto length = static_cast<batch_message_length_t>(message.size());
+
+    auto offset = payload_storage_.size();
+    payload_storage_.resize(offset + batch_message_size(message));
+    std::memcpy(payload_storage_.data() + offset,
+                &length,
+                sizeof(length));
+    std::memcpy(payload_storage_.data() + offset + sizeof(length),
+                message.data(),
+                message.size());
+    payload_ = payload_storage_;
+
+    if (processed) {
+      if (!batch_processed_) {
+        // `processed_` refers `batch_processed_` by shared_ptr
+        // since `processed_` might be called after the entry is destroyed.
+        batch_processed_ = std::make_shared<std::vector<std::function<void()>>>();
+        if (processed_) {
+          batch_processed_->push_back(processed_);
+        }
+        processed_ = [batch_processed = batch_processed_] {
+          for (const auto& p : *batch_processed) {
+            p();
+          }
+        };
+      }
+
+      batch_processed_->push_back(processed);
     }
+  }
+
+  // Move futures and completion handlers of `entry` into the batch.
+  void take_completions(send_entry& entry) {
+    std::move(std::begin(entry.promises_),
+              std::end(entry.promises_),
+              std::back_inserter(promises_));
+    entry.promises_.clear();
 
-    return asio::const_buffer(
-        buffer_.data() + bytes_transferred_,
-        buffer_.size() - bytes_transferred_);
+    std::move(std::begin(entry.completion_handlers_),
+              std::end(entry.completion_handlers_),
+              std::back_inserter(completion_handlers_));
+    entry.completion_handlers_.clear();
+
+    if (entry.batch_completion_) {
+      add_batch_completion(entry.batch_completion_);
+      entry.batch_completion_ = nullptr;
+    }
+    for (const auto& c : entry.extra_batch_completions_) {
+      add_batch_completion(c);
+    }
+    entry.extra_batch_completions_.clear();
+  }
+
+  // Returns the header and the payload buffers except already transferred bytes.
+  [[nodiscard]] std::array<asio::const_buffer, 2> make_buffers() const {
+    std::array<asio::const_buffer, 2> buffers{
+        asio::const_buffer(&header_, sizeof(header_)),
+        asio::const_buffer(payload_.data(), payload_.size()),
+    };
+
+    auto skip = bytes_transferred_;
+    for (auto&& b : buffers) {
+      auto n = std::min(skip, b.size());
+      b += n;
+      skip -= n;
+    }
+
+    return buffers;
   }
 
   void add_bytes_transferred(size_t value) {
@@ -107,22 +359,51 @@ public:
   }
 
   [[nodiscard]] size_t rest_bytes() const {
-    if (bytes_transferred_ >= buffer_.size()) {
+    if (bytes_transferred_ >= size()) {
       return 0;
     }
 
-    return buffer_.size() - bytes_transferred_;
+    return size() - bytes_transferred_;
   }
 
   [[nodiscard]] bool transfer_complete() const {
-    return bytes_transferred_ >= buffer_.size();
+    return bytes_transferred_ >= size();
+  }
+
+  [[nodiscard]] size_t size() const {
+    return sizeof(header_) + payload_.size();
   }
 
 private:
-  std::shared_ptr<asio::local::datagram_protocol::endpoint> destination_endpoint_;
+  std::shared_ptr<const asio::local::datagram_protocol::endpoint> destination_endpoint_;
   std::function<void()> processed_;
   size_t bytes_transferred_;
   size_t no_buffer_space_error_count_;
-  std::vector<uint8_t> buffer_;
+  std::optional<asio::steady_timer::time_point> deadline_;
+
+  // |type (uint8_t)|
+  uint8_t header_;
+
+  // `payload_` refers `payload_storage_` or the buffer owned by `payload_owner_`.
+  std::vector<uint8_t> payload_storage_;
+  std::shared_ptr<const void> payload_owner_;
+  std::span<const uint8_t> payload_;
+
+  // `processed` of messages in the batch.
+  std::shared_ptr<std::vector<std::function<void()>>> batch_processed_;
+
+  // Promises of futures which are returned by `make_future`.
+  // (A batch holds promises of messages in the batch.)
+  std::vector<std::promise<send_status>> promises_;
+  std::vector<asio::any_completion_handler<void(send_status)>> completion_handlers_;
+  // Completions of `async_send_batch`.
+  // (Only a coalesced batch holds several completions.)
+  std::shared_ptr<send_batch_completion> batch_completion_;
+  std::vector<not_null_shared_ptr_t<send_batch_completion>> extra_batch_completions_;
+
+  // The intrusive link of `send_handoff_queue`.
+  // (`handoff_self_` keeps the entry alive while the entry is in the queue.)
+  std::shared_ptr<send_entry> handoff_self_;
+  send_entry* handoff_next_;
 };
 } // namespace pqrs::local_datagram::impl
@@ -0,0 +1,216 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::local_datagram::impl::send_entry_pool` can be used safely in a multi-threaded environment.
+
+#include "send_entry.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <pqrs/gsl.hpp>
+#include <span>
+#include <vector>
+
+namespace pqrs::local_datagram::impl {
+
+// Free slabs are kept in a lock-free stack, so producers do not lock when they take or return a slab.
+// (The stack head has a tag which is changed on each update in order to avoid the ABA problem.)
+class send_entry_pool final : public std::enable_shared_from_this<send_entry_pool> {
+public:
+  send_entry_pool(const send_entry_pool&) = delete;
+
+  // `inline_payload_size` is the maximum payload size which is stored in the slab by `copy_entry`.
+  // `max_slab_count` is the maximum number of slabs. Entries are allocated from the heap when all slabs are in use.
+  send_entry_pool(size_t inline_payload_size,
+                  size_t max_slab_count)
+      : inline_payload_size_(inline_payload_size),
+        max_slab_count_(std::min(max_slab_count,
+                                 size_t(std::numeric_limits<uint32_t>::max() - 1))),
+        slabs_(max_slab_count_),
+        slab_count_(0),
+        free_slabs_head_(0) {
+  }
+
+  // Returns an entry which holds a copy of `payload`.
+  // `payload` is stored in the slab if `payload.size()` <= `inline_payload_size`.
+  [[nodiscard]] not_null_shared_ptr_t<send_entry> copy_entry(send_entry::type t,
+                                                             std::span<const uint8_t> payload,
+                                                             std::shared_ptr<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                                                             std::function<void()> processed = nullptr) {
+    if (payload.size() <= inline_payload_size_) {
+      if (auto s = pop_free_slab()) {
+        s->payload.assign(std::begin(payload),
+                          std::end(payload));
+
+        // The payload is owned by the slab which outlives the entry.
+        return std::allocate_shared<send_entry>(slab_allocator<send_entry>(shared_from_this(), s),
+                                                t,
+                                                std::span<const uint8_t>(s->payload),
+                                                nullptr,
+                                                destination_endpoint,
+                                                processed);
+      }
+    }
+
+    return std::make_shared<send_entry>(t,
+                                        payload.data(),
+                                        payload.size(),
+                                        destination_endpoint,
+                                        processed);
+  }
+
+  // Returns an entry which is constructed with `args` in the slab.
+  // (The payload is not stored in the slab.)
+  template <typename... Args>
+  [[nodiscard]] not_null_shared_ptr_t<send_entry> make_entry(Args&&... args) {
+    if (auto s = pop_free_slab()) {
+      return std::allocate_shared<send_entry>(slab_allocator<send_entry>(shared_from_this(), s),
+                                              std::forward<Args>(args)...);
+    }
+
+    return std::make_shared<send_entry>(std::forward<Args>(args)...);
+  }
+
+  [[nodiscard]] size_t get_inline_payload_size() const {
+    return inline_payload_size_;
+  }
+
+  [[nodiscard]] size_t get_slab_count() const {
+    return slab_count_;
+  }
+
+private:
+  struct slab final {
+    std::vector<uint8_t> payload;
+
+    // The entry and the control block of `std::shared_ptr` are placed in the slab in order to avoid heap allocation.
+    alignas(std::max_align_t) std::byte storage[sizeof(send_entry) + 128];
+
+    uint32_t index = 0;
+    // `index + 1` of the next free slab. (0 means the end of the stack.)
+    std::atomic<uint32_t> next = 0;
+  };
+
+  // An allocator which places the entry and the `std::shared_ptr` control block in the slab,
+  // and returns the slab to the pool when the control block is deallocated.
+  template <typename T>
+  class slab_allocator final {
+  public:
+    using value_type = T;
+
+    slab_allocator(std::shared_ptr<send_entry_pool> pool,
+                   slab* s)
+        : pool_(pool),
+          slab_(s) {
+    }
+
+    template <typename U>
+    slab_allocator(const slab_allocator<U>& other)
+        : pool_(other.pool_),
+          slab_(other.slab_) {
+    }
+
+    [[nodiscard]] T* allocate(size_t n) {
+      if (sizeof(T) * n <= sizeof(slab_->storage) &&
+          alignof(T) <= alignof(std::max_align_t)) {
+        return reinterpret_cast<T*>(slab_->storage);
+      }
+
+      return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+      if (reinterpret_cast<std::byte*>(p) != slab_->storage) {
+        std::allocator<T>().deallocate(p, n);
+      }
+
+      // The entry is already destroyed at this point.
+      pool_->push_free_slab(slab_);
+    }
+
+    template <typename U>
+    bool operator==(const slab_allocator<U>& other) const {
+      return slab_ == other.slab_;
+    }
+
+  private:
+    template <typename U>
+    friend class slab_allocator;
+
+    std::shared_ptr<send_entry_pool> pool_;
+    slab* slab_;
+  };
+
+  // The stack head consists of the tag (upper 32 bits) and `index + 1` of the top slab (lower 32 bits).
+  static constexpr uint64_t free_slabs_index_mask = 0xffffffff;
+
+  static uint64_t make_free_slabs_head(uint64_t previous_head,
+                                       uint32_t index) {
+    auto tag = (previous_head >> 32) + 1;
+    return (tag << 32) | index;
+  }
+
+  slab* pop_free_slab() {
+    auto head = free_slabs_head_.load(std::memory_order_acquire);
+    while (auto index = uint32_t(head & free_slabs_index_mask)) {
+      auto s = slabs_[index - 1].get();
+
+      // `next` might be stale if another thread takes the slab at the same time.
+      // In that case, the tag is changed and `compare_exchange_weak` fails.
+      auto new_head = make_free_slabs_head(head,
+                                           s->next.load(std::memory_order_relaxed));
+      if (free_slabs_head_.compare_exchange_weak(head,
+                                                 new_head,
+                                                 std::memory_order_acquire,
+                                                 std::memory_order_acquire)) {
+        return s;
+      }
+    }
+
+    // Create a new slab if the number of slabs does not reach `max_slab_count_`.
+    auto count = slab_count_.load(std::memory_order_relaxed);
+    while (count < max_slab_count_) {
+      if (slab_count_.compare_exchange_weak(count,
+                                            count + 1,
+                                            std::memory_order_relaxed)) {
+        auto s = std::make_unique<slab>();
+        s->payload.reserve(inline_payload_size_);
+        s->index = count;
+        slabs_[count] = std::move(s);
+        return slabs_[count].get();
+      }
+    }
+
+    return nullptr;
+  }
+
+  void push_free_slab(slab* s) {
+    auto head = free_slabs_head_.load(std::memory_order_relaxed);
+    uint64_t new_head = 0;
+    do {
+      s->next.store(uint32_t(head & free_slabs_index_mask),
+                    std::memory_order_relaxed);
+      new_head = make_free_slabs_head(head,
+                                      s->index + 1);
+    } while (!free_slabs_head_.compare_exchange_weak(head,
+                                                     new_head,
+                                                     std::memory_order_release,
+                                                     std::memory_order_relaxed));
+  }
+
+  size_t inline_payload_size_;
+  size_t max_slab_count_;
+
+  // Slabs are created up to `max_slab_count_` and never removed until the pool is destroyed.
+  // (`slabs_` is not resized after the construction.)
+  std::vector<std::unique_ptr<slab>> slabs_;
+  std::atomic<size_t> slab_count_;
+  std::atomic<uint64_t> free_slabs_head_;
+};
+} // namespace pqrs::local_datagram::impl
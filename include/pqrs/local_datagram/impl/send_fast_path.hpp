@@ -0,0 +1,130 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::local_datagram::impl::send_fast_path` can be used safely in a multi-threaded environment.
+
+#include "send_entry.hpp"
+#include <atomic>
+#include <cerrno>
+#include <span>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <thread>
+
+namespace pqrs::local_datagram::impl {
+
+// `send_fast_path` sends data on the calling thread without passing it to `io_ctx_thread_`
+// while the socket is connected and the send queue is empty.
+//
+// The fast path is not used while any entry is queued in order to preserve the order of data.
+// (The caller also has to ensure no entry is in `send_handoff_queue`.)
+//
+// `try_send` does not lock.
+// Instead, `disable` waits until `try_send` calls which might use the previous socket return.
+class send_fast_path final {
+public:
+  send_fast_path(const send_fast_path&) = delete;
+
+  send_fast_path()
+      : native_handle_(-1),
+        queued_(false),
+        senders_(0),
+        user_data_sent_(false) {
+  }
+
+  // This method is executed in `io_ctx_thread_`.
+  void enable(int native_handle) {
+    native_handle_ = native_handle;
+  }
+
+  // The socket can be closed after `disable` since `try_send` is not using it.
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void disable() {
+    native_handle_ = -1;
+
+    // `sendmsg` in `try_send` does not block. (MSG_DONTWAIT)
+    while (senders_ > 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  // Set whether the send queue has entries.
+  // (It is called only when the send queue becomes empty or non-empty.)
+  //
+  // This method is executed in `io_ctx_thread_`.
+  void set_queued(bool value) {
+    queued_ = value;
+  }
+
+  // Returns true if `payload` is sent.
+  // Returns false if the fast path is unavailable or `send` fails. (e.g., EAGAIN, ENOBUFS)
+  [[nodiscard]] bool try_send(send_entry::type t,
+                              std::span<const uint8_t> payload) {
+    // `senders_` is incremented before `native_handle_` is loaded,
+    // so `disable` waits for this call if this call loads the previous socket.
+    ++senders_;
+
+    auto result = false;
+
+    auto native_handle = native_handle_.load();
+    if (native_handle >= 0 &&
+        !queued_) {
+      result = send(native_handle,
+                    t,
+                    payload);
+
+      if (result &&
+          t == send_entry::type::user_data) {
+        user_data_sent_ = true;
+      }
+    }
+
+    --senders_;
+
+    return result;
+  }
+
+  // Returns true if user data is sent by `try_send` after the last call.
+  [[nodiscard]] bool take_user_data_sent() {
+    return user_data_sent_.exchange(false);
+  }
+
+private:
+  static bool send(int native_handle,
+                   send_entry::type t,
+                   std::span<const uint8_t> payload) {
+    auto header = static_cast<uint8_t>(t);
+
+    iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = const_cast<uint8_t*>(payload.data());
+    iov[1].iov_len = payload.size();
+
+    msghdr h{};
+    h.msg_iov = iov;
+    h.msg_iovlen = 2;
+
+    while (true) {
+      auto r = sendmsg(native_handle, &h, MSG_DONTWAIT);
+      if (r >= 0) {
+        return true;
+      }
+
+      if (errno != EINTR) {
+        return false;
+      }
+    }
+  }
+
+  std::atomic<int> native_handle_;
+  std::atomic<bool> queued_;
+  // The number of `try_send` calls which are running.
+  std::atomic<size_t> senders_;
+  std::atomic<bool> user_data_sent_;
+};
+} // namespace pqrs::local_datagram::impl
@@ -0,0 +1,186 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::local_datagram::impl::send_handoff_queue` can be used safely in a multi-threaded environment.
+
+#include "send_entry.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <pqrs/gsl.hpp>
+#include <span>
+
+namespace pqrs::local_datagram::impl {
+
+// A multi-producer single-consumer queue which hands send entries from producers to the consumer (`io_ctx_thread_`).
+//
+// Producers push entries by compare-and-swap.
+// The consumer is woken up only when the queue goes from empty to non-empty,
+// and only the wakeup (and attaching or detaching the consumer) takes `mutex_`.
+//
+// States:
+// - attached: The consumer is woken up by `wakeup` and drains entries.
+// - suspended: Entries are kept until the next consumer is attached.
+// - orphaned: Entries are passed to `orphan_handler` in the producer thread. (e.g., the client is stopped.)
+class send_handoff_queue final {
+public:
+  send_handoff_queue(const send_handoff_queue&) = delete;
+
+  send_handoff_queue(std::function<void(not_null_shared_ptr_t<send_entry>)> orphan_handler)
+      : head_(nullptr),
+        pending_count_(0),
+        orphan_handler_(orphan_handler),
+        consumer_(nullptr),
+        suspended_(false) {
+  }
+
+  ~send_handoff_queue() {
+    // Release entries which are not drained.
+    drain([](auto&&) {});
+  }
+
+  void push(not_null_shared_ptr_t<send_entry> entry) {
+    push_all(std::span<const not_null_shared_ptr_t<send_entry>>(&entry, 1));
+  }
+
+  // Push `entries` as a single unit.
+  // The consumer takes all `entries` in the same `drain`.
+  void push_all(std::span<const not_null_shared_ptr_t<send_entry>> entries) {
+    if (entries.empty()) {
+      return;
+    }
+
+    pending_count_ += entries.size();
+
+    // Link entries in the reverse order since `head_` is the last pushed entry.
+    send_entry* first = nullptr;
+    send_entry* last = nullptr;
+    for (const auto& entry : entries) {
+      auto e = entry.get().get();
+
+      // The entry keeps itself alive while it is in the queue.
+      e->handoff_self_ = entry;
+
+      e->handoff_next_ = last;
+      last = e;
+      if (!first) {
+        first = e;
+      }
+    }
+
+    auto head = head_.load(std::memory_order_relaxed);
+    do {
+      first->handoff_next_ = head;
+    } while (!head_.compare_exchange_weak(head,
+                                          last,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+
+    if (head == nullptr) {
+      wake();
+    }
+  }
+
+  // `wakeup` is called when entries are pushed into the empty queue.
+  // (`wakeup` has to call `drain` in the consumer thread.)
+  void attach(const void* consumer,
+              std::function<void()> wakeup) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      consumer_ = consumer;
+      wakeup_ = wakeup;
+      suspended_ = false;
+    }
+
+    // Wake the consumer for entries which are pushed while the queue is suspended.
+    if (head_.load(std::memory_order_acquire) != nullptr) {
+      wake();
+    }
+  }
+
+  // Stop waking `consumer` and keep entries until the next `attach`.
+  // `wakeup` is never called after `suspend` returns.
+  void suspend(const void* consumer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (consumer_ == consumer) {
+      consumer_ = nullptr;
+      wakeup_ = nullptr;
+      suspended_ = true;
+    }
+  }
+
+  // Pass remaining and future entries to `orphan_handler` until the next `attach`.
+  //
+  // The caller has to ensure the previous consumer does not call `drain`.
+  void detach() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      consumer_ = nullptr;
+      wakeup_ = nullptr;
+      suspended_ = false;
+    }
+
+    wake();
+  }
+
+  // Call `f` for each entry in the pushed order.
+  //
+  // This method is executed in the consumer thread.
+  template <typename F>
+  void drain(F&& f) {
+    auto head = head_.exchange(nullptr, std::memory_order_acquire);
+
+    // Reverse the list in order to take entries in the pushed order.
+    send_entry* entries = nullptr;
+    while (head) {
+      auto next = head->handoff_next_;
+      head->handoff_next_ = entries;
+      entries = head;
+      head = next;
+    }
+
+    while (entries) {
+      auto next = entries->handoff_next_;
+      entries->handoff_next_ = nullptr;
+
+      auto entry = std::move(entries->handoff_self_);
+      entries = next;
+
+      f(not_null_shared_ptr_t<send_entry>(entry));
+
+      --pending_count_;
+    }
+  }
+
+  // Returns the number of entries which are pushed and not processed by `drain` yet.
+  [[nodiscard]] size_t get_pending_count() const {
+    return pending_count_;
+  }
+
+private:
+  void wake() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (wakeup_) {
+      wakeup_();
+    } else if (!suspended_) {
+      // `drain` is serialized by `mutex_` while the queue is orphaned.
+      drain(orphan_handler_);
+    }
+  }
+
+  std::atomic<send_entry*> head_;
+  std::atomic<size_t> pending_count_;
+  std::function<void(not_null_shared_ptr_t<send_entry>)> orphan_handler_;
+  std::mutex mutex_;
+  const void* consumer_;
+  std::function<void()> wakeup_;
+  bool suspended_;
+};
+} // namespace pqrs::local_datagram::impl
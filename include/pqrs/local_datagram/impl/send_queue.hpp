@@ -0,0 +1,445 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::local_datagram::impl::send_queue` cannot be used safely in a multi-threaded environment.
+// (It is owned by `io_ctx_thread_`.)
+
+#include "asio_helper.hpp"
+#include "send_entry.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <pqrs/gsl.hpp>
+#include <string>
+#include <string_view>
+#include <sys/un.h>
+#include <unordered_map>
+#include <vector>
+
+namespace pqrs::local_datagram::impl {
+
+// A send queue which holds a FIFO queue per destination endpoint.
+// Destinations are served in the round-robin order, and parked destinations are skipped until they are unparked.
+// (All entries have the same destination in client mode. Thus, `send_queue` works as a single FIFO queue.)
+//
+// - Destinations which are ready to send are linked in an intrusive list, so rotating and unlinking them are O(1).
+// - Parked destinations are ordered by the unpark time.
+// - Destinations are also ordered by the sequence of their front entries for `pop_oldest`.
+class send_queue final {
+public:
+  struct key_hash final {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view value) const {
+      return std::hash<std::string_view>{}(value);
+    }
+  };
+
+  // Use `sun_path` bytes as a key in order to avoid `endpoint::path()` which creates `std::string`.
+  // (The key of entries which do not have the destination endpoint is empty.)
+  static std::string_view make_key(const asio::local::datagram_protocol::endpoint* endpoint) {
+    auto offset = offsetof(sockaddr_un, sun_path);
+    if (!endpoint ||
+        endpoint->size() <= offset) {
+      return std::string_view();
+    }
+
+    return std::string_view(reinterpret_cast<const char*>(endpoint->data()) + offset,
+                            endpoint->size() - offset);
+  }
+
+  send_queue(const send_queue&) = delete;
+
+  send_queue()
+      : ready_front_(nullptr),
+        ready_back_(nullptr),
+        sweep_threshold_(minimum_sweep_threshold),
+        last_sequence_(0),
+        size_(0),
+        bytes_(0) {
+  }
+
+  [[nodiscard]] bool empty() const {
+    return size_ == 0;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return size_;
+  }
+
+  // Returns the total size of the queued entries.
+  [[nodiscard]] size_t get_bytes() const {
+    return bytes_;
+  }
+
+  void push_back(not_null_shared_ptr_t<send_entry> entry) {
+    auto& d = find_or_create_destination(entry->get_destination_endpoint().get());
+
+    d.items.push_back(item{++last_sequence_, entry});
+    ++size_;
+    bytes_ += entry->size();
+
+    if (d.state == destination_state::idle) {
+      update_front(d);
+      d.state = destination_state::ready;
+      link_ready(d);
+    }
+  }
+
+  // Append up to `max_count` entries which should be sent next into `entries`.
+  // Entries are taken in the round-robin order of destinations which are not parked at `now`.
+  // (Entries are not removed from the queue.)
+  void get_ready_entries(size_t max_count,
+                         asio::steady_timer::time_point now,
+                         std::vector<not_null_shared_ptr_t<send_entry>>& entries) {
+    unpark_until(now);
+
+    for (size_t i = 0; entries.size() < max_count; ++i) {
+      bool found = false;
+
+      for (auto d = ready_front_; d; d = d->next) {
+        if (i < d->items.size()) {
+          found = true;
+          entries.push_back(d->items[i].entry);
+
+          if (entries.size() >= max_count) {
+            break;
+          }
+        }
+      }
+
+      if (!found) {
+        break;
+      }
+    }
+  }
+
+  // Remove `entry` which is the front entry of its destination.
+  // The destination is moved to the end of the round-robin order.
+  void pop(const send_entry& entry) {
+    auto it = destinations_.find(make_key(entry.get_destination_endpoint().get()));
+    if (it == std::end(destinations_)) {
+      return;
+    }
+
+    auto& d = it->second;
+    if (d.items.empty() ||
+        d.items.front().entry.get().get() != &entry) {
+      return;
+    }
+
+    if (d.state == destination_state::parked) {
+      unlink_parked(d);
+    } else {
+      unlink_ready(d);
+    }
+    d.state = destination_state::ready;
+    link_ready(d);
+
+    erase_item(d, std::begin(d.items));
+  }
+
+  // Returns the last entry for `destination_endpoint`.
+  [[nodiscard]] std::shared_ptr<send_entry> back(const asio::local::datagram_protocol::endpoint* destination_endpoint) const {
+    auto it = destinations_.find(make_key(destination_endpoint));
+    if (it == std::end(destinations_) ||
+        it->second.items.empty()) {
+      return nullptr;
+    }
+
+    return it->second.items.back().entry;
+  }
+
+  // Update the total size when the size of a queued entry is changed.
+  void add_bytes(size_t value) {
+    bytes_ += value;
+  }
+
+  // Remove `entry` without changing the round-robin order.
+  void erase(const send_entry& entry) {
+    auto it = destinations_.find(make_key(entry.get_destination_endpoint().get()));
+    if (it == std::end(destinations_)) {
+      return;
+    }
+
+    auto& d = it->second;
+    auto item_it = std::find_if(std::begin(d.items),
+                                std::end(d.items),
+                                [&entry](const auto& i) {
+                                  return i.entry.get().get() == &entry;
+                                });
+    if (item_it != std::end(d.items)) {
+      erase_item(d, item_it);
+    }
+  }
+
+  // Remove the oldest entry except `excluded` and returns it.
+  // Returns nullptr if there is no entry which can be removed.
+  std::shared_ptr<send_entry> pop_oldest(const send_entry* excluded) {
+    destination* oldest_destination = nullptr;
+    std::deque<item>::iterator oldest_item;
+
+    // Only a few front entries are skipped (the excluded entry and partially sent entries),
+    // so the search stops soon after the front sequence exceeds the oldest candidate.
+    for (const auto& [front_sequence, d] : fronts_) {
+      if (oldest_destination &&
+          front_sequence > oldest_item->sequence) {
+        break;
+      }
+
+      auto it = std::find_if(std::begin(d->items),
+                             std::end(d->items),
+                             [excluded](const auto& i) {
+                               return i.entry.get().get() != excluded &&
+                                      i.entry->get_bytes_transferred() == 0;
+                             });
+      if (it == std::end(d->items)) {
+        continue;
+      }
+
+      if (!oldest_destination ||
+          it->sequence < oldest_item->sequence) {
+        oldest_destination = d;
+        oldest_item = it;
+      }
+    }
+
+    if (!oldest_destination) {
+      return nullptr;
+    }
+
+    std::shared_ptr<send_entry> entry = oldest_item->entry;
+    erase_item(*oldest_destination, oldest_item);
+    return entry;
+  }
+
+  // Skip entries for `destination_endpoint` until `until`.
+  void park(const asio::local::datagram_protocol::endpoint* destination_endpoint,
+            asio::steady_timer::time_point until) {
+    auto it = destinations_.find(make_key(destination_endpoint));
+    if (it == std::end(destinations_)) {
+      return;
+    }
+
+    auto& d = it->second;
+    switch (d.state) {
+      case destination_state::idle:
+        return;
+
+      case destination_state::ready:
+        unlink_ready(d);
+        break;
+
+      case destination_state::parked:
+        unlink_parked(d);
+        break;
+    }
+
+    d.state = destination_state::parked;
+    link_parked(d, until);
+  }
+
+  // The destination is moved to the end of the round-robin order.
+  void unpark(const asio::local::datagram_protocol::endpoint* destination_endpoint) {
+    auto it = destinations_.find(make_key(destination_endpoint));
+    if (it != std::end(destinations_) &&
+        it->second.state == destination_state::parked) {
+      unpark(it->second);
+    }
+  }
+
+  void unpark_all() {
+    while (!parked_.empty()) {
+      unpark(*(std::begin(parked_)->second));
+    }
+  }
+
+  // Returns the earliest time when a parked destination is unparked.
+  [[nodiscard]] std::optional<asio::steady_timer::time_point> get_unpark_time() const {
+    if (parked_.empty()) {
+      return std::nullopt;
+    }
+
+    return std::begin(parked_)->first;
+  }
+
+private:
+  static constexpr size_t minimum_sweep_threshold = 64;
+
+  struct destination;
+
+  struct item final {
+    uint64_t sequence;
+    not_null_shared_ptr_t<send_entry> entry;
+  };
+
+  enum class destination_state {
+    // The destination has no entry.
+    idle,
+    // The destination is linked in the ready list.
+    ready,
+    // The destination is in `parked_`.
+    parked,
+  };
+
+  using parked_map = std::multimap<asio::steady_timer::time_point, destination*>;
+  using front_map = std::map<uint64_t, destination*>;
+
+  struct destination final {
+    std::deque<item> items;
+    destination_state state = destination_state::idle;
+    // Links of the ready list.
+    destination* previous = nullptr;
+    destination* next = nullptr;
+    parked_map::iterator parked_position;
+    front_map::iterator front_position;
+    // Nodes which are extracted from `parked_` and `fronts_` are kept in order to reinsert them without allocation.
+    parked_map::node_type parked_node;
+    front_map::node_type front_node;
+  };
+
+  destination& find_or_create_destination(const asio::local::datagram_protocol::endpoint* endpoint) {
+    auto key = make_key(endpoint);
+
+    if (auto it = destinations_.find(key); it != std::end(destinations_)) {
+      return it->second;
+    }
+
+    if (destinations_.size() >= sweep_threshold_) {
+      // Remove idle destinations.
+      std::erase_if(destinations_, [](const auto& pair) {
+        return pair.second.state == destination_state::idle;
+      });
+
+      sweep_threshold_ = std::max(minimum_sweep_threshold,
+                                  destinations_.size() * 2);
+    }
+
+    return destinations_[std::string(key)];
+  }
+
+  void erase_item(destination& d,
+                  std::deque<item>::iterator it) {
+    --size_;
+    bytes_ -= it->entry->size();
+
+    auto front = (it == std::begin(d.items));
+
+    d.items.erase(it);
+
+    if (d.items.empty()) {
+      switch (d.state) {
+        case destination_state::idle:
+          break;
+
+        case destination_state::ready:
+          unlink_ready(d);
+          break;
+
+        case destination_state::parked:
+          unlink_parked(d);
+          break;
+      }
+
+      d.state = destination_state::idle;
+      d.front_node = fronts_.extract(d.front_position);
+
+    } else if (front) {
+      update_front(d);
+    }
+  }
+
+  void unpark(destination& d) {
+    unlink_parked(d);
+    d.state = destination_state::ready;
+    link_ready(d);
+  }
+
+  // Unpark destinations whose unpark time is passed at `now`.
+  void unpark_until(asio::steady_timer::time_point now) {
+    while (!parked_.empty() &&
+           std::begin(parked_)->first <= now) {
+      unpark(*(std::begin(parked_)->second));
+    }
+  }
+
+  void link_ready(destination& d) {
+    d.previous = ready_back_;
+    d.next = nullptr;
+
+    if (ready_back_) {
+      ready_back_->next = &d;
+    } else {
+      ready_front_ = &d;
+    }
+    ready_back_ = &d;
+  }
+
+  void unlink_ready(destination& d) {
+    if (d.previous) {
+      d.previous->next = d.next;
+    } else {
+      ready_front_ = d.next;
+    }
+
+    if (d.next) {
+      d.next->previous = d.previous;
+    } else {
+      ready_back_ = d.previous;
+    }
+
+    d.previous = nullptr;
+    d.next = nullptr;
+  }
+
+  void link_parked(destination& d,
+                   asio::steady_timer::time_point until) {
+    if (d.parked_node) {
+      d.parked_node.key() = until;
+      d.parked_position = parked_.insert(std::move(d.parked_node));
+    } else {
+      d.parked_position = parked_.emplace(until, &d);
+    }
+  }
+
+  void unlink_parked(destination& d) {
+    d.parked_node = parked_.extract(d.parked_position);
+  }
+
+  // Update the position in `fronts_` by the sequence of the front entry.
+  // (Idle destinations are not in `fronts_`.)
+  void update_front(destination& d) {
+    auto sequence = d.items.front().sequence;
+
+    if (d.state != destination_state::idle) {
+      d.front_node = fronts_.extract(d.front_position);
+    }
+
+    if (d.front_node) {
+      d.front_node.key() = sequence;
+      d.front_position = fronts_.insert(std::move(d.front_node)).position;
+    } else {
+      d.front_position = fronts_.emplace(sequence, &d).first;
+    }
+  }
+
+  std::unordered_map<std::string, destination, key_hash, std::equal_to<>> destinations_;
+  // The ready list. (Destinations which have entries and are not parked, in the round-robin order.)
+  destination* ready_front_;
+  destination* ready_back_;
+  parked_map parked_;
+  // Destinations which have entries, ordered by the sequence of their front entries.
+  front_map fronts_;
+  size_t sweep_threshold_;
+  uint64_t last_sequence_;
+  size_t size_;
+  size_t bytes_;
+};
+} // namespace pqrs::local_datagram::impl
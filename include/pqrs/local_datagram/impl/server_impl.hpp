@@ -7,7 +7,7 @@
 // `pqrs::local_datagram::impl::server_impl` can be used safely in a multi-threaded environment.
 
 #include "base_impl.hpp"
-#include "client_impl.hpp"
+#include <algorithm>
 #include <filesystem>
 #include <nod/nod.hpp>
 #include <pqrs/dispatcher.hpp>
@@ -21,17 +21,22 @@ public:
   server_impl(const server_impl&) = delete;
 
   server_impl(std::weak_ptr<dispatcher::dispatcher> weak_dispatcher,
-              not_null_shared_ptr_t<std::deque<not_null_shared_ptr_t<send_entry>>> send_entries)
+              not_null_shared_ptr_t<send_queue> send_entries)
       : base_impl(weak_dispatcher,
                   base_impl::mode::server,
-                  send_entries),
-        server_check_timer_(*this),
-        server_check_client_send_entries_(std::make_shared<std::deque<not_null_shared_ptr_t<impl::send_entry>>>()) {
+                  send_entries,
+                  std::make_shared<send_fast_path>()),
+        server_check_timer_(io_ctx_, asio_helper::time_point::pos_infin()) {
   }
 
   ~server_impl() {
     async_close();
 
+    // `server_check_timer_` keeps `io_ctx_` running until it is canceled.
+    asio::post(io_ctx_, [this] {
+      stop_server_check();
+    });
+
     terminate_base_impl();
   }
 
@@ -88,8 +93,9 @@ public:
       // Signal
 
       socket_ready_ = true;
-      ++next_heartbeat_deadline_timers_generation_;
+      reset_next_heartbeat_deadlines();
 
+      stop_server_check();
       start_server_check(server_socket_file_path,
                          server_check_interval);
 
@@ -102,62 +108,77 @@ public:
   }
 
 private:
+  // The socket file is checked by `server_check_timer_` in `io_ctx_thread_` without waking the dispatcher thread.
+  //
   // This method is executed in `io_ctx_thread_`.
   void start_server_check(const std::filesystem::path& server_socket_file_path,
                           std::optional<std::chrono::milliseconds> server_check_interval) {
+    if (server_check_interval ||
+        socket_file_watch_) {
+      // The probe remembers the bound file.
+      server_check_probe_ = std::make_unique<socket_file_probe>(server_socket_file_path);
+    }
+
+    if (socket_file_watch_) {
+      socket_file_watcher_ = std::make_unique<socket_file_watcher>(io_ctx_,
+                                                                   server_socket_file_path,
+                                                                   [this] {
+                                                                     check_server();
+                                                                   });
+    }
+
+    // The polling check is also used as a fallback of the watcher.
+    // (It is lengthened while the watcher is available.)
     if (server_check_interval) {
-      server_check_timer_.start(
-          [this, server_socket_file_path] {
-            asio::post(io_ctx_, [this, server_socket_file_path] {
-              check_server(server_socket_file_path);
-            });
-          },
-          *server_check_interval);
+      auto interval = *server_check_interval;
+      if (socket_file_watcher_ &&
+          socket_file_watcher_->watching()) {
+        interval = std::max(interval, watched_socket_file_check_interval);
+      }
+
+      server_check_timer_.expires_at(asio_helper::time_point::now());
+      wait_server_check(interval);
     }
   }
 
+  // This method is executed in `io_ctx_thread_`.
+  void wait_server_check(std::chrono::milliseconds server_check_interval) {
+    server_check_timer_.async_wait(
+        [this,
+         server_check_interval](const auto& error_code) {
+          if (error_code == asio::error::operation_aborted) {
+            return;
+          }
+
+          check_server();
+
+          if (server_check_probe_) {
+            server_check_timer_.expires_after(server_check_interval);
+            wait_server_check(server_check_interval);
+          }
+        });
+  }
+
   // This method is executed in `io_ctx_thread_`.
   void stop_server_check() {
-    server_check_timer_.stop();
-    server_check_client_impl_ = nullptr;
+    server_check_timer_.cancel();
+    server_check_probe_ = nullptr;
+    socket_file_watcher_ = nullptr;
   }
 
   // This method is executed in `io_ctx_thread_`.
-  void check_server(const std::filesystem::path& server_socket_file_path) {
+  void check_server() {
     if (!socket_ ||
-        !socket_ready_) {
+        !socket_ready_ ||
+        !server_check_probe_) {
       stop_server_check();
       return;
     }
 
-    if (!server_check_client_impl_) {
-      server_check_client_impl_ = std::make_unique<client_impl>(
-          weak_dispatcher_,
-          server_check_client_send_entries_);
-
-      server_check_client_impl_->connected.connect([this](auto&& peer_pid) {
-        asio::post(io_ctx_, [this] {
-          server_check_client_impl_ = nullptr;
-        });
-      });
-
-      server_check_client_impl_->connect_failed.connect([this](auto&& error_code) {
-        async_close();
-      });
-
-      size_t buffer_size = 32;
-      server_check_client_impl_->async_connect(server_socket_file_path,
-                                               std::nullopt, // client_socket_file_path
-                                               buffer_size,
-                                               std::nullopt, // server_check_interval
-                                               std::nullopt, // next_heartbeat_deadline
-                                               std::nullopt  // client_socket_check_interval
-      );
-    }
+    check_socket_file(*server_check_probe_);
   }
 
-  dispatcher::extra::timer server_check_timer_;
-  std::unique_ptr<client_impl> server_check_client_impl_;
-  not_null_shared_ptr_t<std::deque<not_null_shared_ptr_t<send_entry>>> server_check_client_send_entries_;
+  asio::steady_timer server_check_timer_;
+  std::unique_ptr<socket_file_probe> server_check_probe_;
 };
 } // namespace pqrs::local_datagram::impl
@@ -0,0 +1,139 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::local_datagram::impl::socket_file_probe` cannot be used safely in a multi-threaded environment.
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <optional>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace pqrs::local_datagram::impl {
+
+// Check whether the socket file which we bound is still reachable.
+//
+// The check is done in the calling thread (`io_ctx_thread_`) with `lstat` and a non-blocking `connect` on a throwaway fd,
+// instead of connecting with `client_impl` which creates its own io thread.
+class socket_file_probe final {
+public:
+  enum class status {
+    reachable,
+    // The file is removed.
+    missing,
+    // The file is replaced with another file. (e.g., another process binds the same path.)
+    replaced,
+    // The file exists but no socket is bound to the file.
+    unreachable,
+  };
+
+  socket_file_probe(const socket_file_probe&) = delete;
+
+  // `path` has to be bound before the probe is created.
+  socket_file_probe(const std::filesystem::path& path)
+      : path_(path),
+        identity_(get_identity(path)) {
+  }
+
+  [[nodiscard]] const std::filesystem::path& get_path() const {
+    return path_;
+  }
+
+  [[nodiscard]] status probe() const {
+    auto identity = get_identity(path_);
+    if (!identity) {
+      return status::missing;
+    }
+
+    if (identity != identity_) {
+      return status::replaced;
+    }
+
+    if (!connectable(path_)) {
+      return status::unreachable;
+    }
+
+    return status::reachable;
+  }
+
+private:
+  // The modification time is also compared since the inode number might be reused immediately after the file is removed.
+  struct identity final {
+    dev_t dev;
+    ino_t ino;
+    time_t mtime_sec;
+    long mtime_nsec;
+
+    bool operator==(const identity&) const = default;
+  };
+
+  static std::optional<identity> get_identity(const std::filesystem::path& path) {
+    struct stat st {};
+    if (lstat(path.c_str(), &st) != 0 ||
+        !S_ISSOCK(st.st_mode)) {
+      return std::nullopt;
+    }
+
+#ifdef __APPLE__
+    const auto& mtime = st.st_mtimespec;
+#else
+    const auto& mtime = st.st_mtim;
+#endif
+
+    return identity{st.st_dev,
+                    st.st_ino,
+                    mtime.tv_sec,
+                    mtime.tv_nsec};
+  }
+
+  static bool connectable(const std::filesystem::path& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    const auto& native = path.native();
+    if (native.size() >= sizeof(address.sun_path)) {
+      return false;
+    }
+    std::memcpy(address.sun_path, native.c_str(), native.size() + 1);
+
+    auto fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) {
+      // Do not close the socket when we cannot check it. (e.g., EMFILE)
+      return true;
+    }
+
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    int r = 0;
+    do {
+      r = connect(fd,
+                  reinterpret_cast<const sockaddr*>(&address),
+                  sizeof(address));
+    } while (r != 0 && errno == EINTR);
+
+    auto connect_errno = errno;
+
+    close(fd);
+
+    if (r == 0) {
+      return true;
+    }
+
+    // Only errors which mean no socket is bound to the file are treated as unreachable.
+    // (e.g., Linux returns EPERM when the socket is connected to another peer.)
+    return connect_errno != ECONNREFUSED &&
+           connect_errno != ENOENT;
+  }
+
+  std::filesystem::path path_;
+  std::optional<identity> identity_;
+};
+} // namespace pqrs::local_datagram::impl
@@ -0,0 +1,128 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::local_datagram::impl::socket_file_watcher` cannot be used safely in a multi-threaded environment.
+// (It is owned by `io_ctx_thread_`.)
+
+#include "asio_helper.hpp"
+#include <filesystem>
+#include <functional>
+
+#ifdef __linux__
+#include <array>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace pqrs::local_datagram::impl {
+
+// Watch the socket file and its parent directory with inotify, and call `changed` when the file might be removed or replaced.
+// `changed` is called in `io_ctx_thread_`.
+//
+// The watcher is available only on Linux.
+// (`watching` returns false on other platforms, and the polling check is used instead.)
+class socket_file_watcher final {
+public:
+  socket_file_watcher(const socket_file_watcher&) = delete;
+
+#ifdef __linux__
+  socket_file_watcher(asio::io_context& io_ctx,
+                      const std::filesystem::path& path,
+                      std::function<void()> changed)
+      : descriptor_(io_ctx),
+        file_name_(path.filename()),
+        changed_(changed) {
+    auto fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+
+    auto parent_path = path.parent_path();
+    if (parent_path.empty()) {
+      parent_path = ".";
+    }
+
+    if (inotify_add_watch(fd,
+                          path.c_str(),
+                          IN_DELETE_SELF | IN_MOVE_SELF | IN_ATTRIB) < 0 ||
+        inotify_add_watch(fd,
+                          parent_path.c_str(),
+                          IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF | IN_MOVE_SELF) < 0) {
+      close(fd);
+      return;
+    }
+
+    descriptor_.assign(fd);
+
+    async_read();
+  }
+
+  // Pending reads are canceled, and `changed` is never called after the watcher is destroyed.
+  ~socket_file_watcher() = default;
+
+  [[nodiscard]] bool watching() const {
+    return descriptor_.is_open();
+  }
+
+private:
+  void async_read() {
+    descriptor_.async_read_some(
+        asio::buffer(buffer_),
+        [this](const auto& error_code, auto bytes_transferred) {
+          if (error_code) {
+            // The watcher is destroyed (operation_aborted) or inotify is broken.
+            // (The polling check is still available in the latter case.)
+            return;
+          }
+
+          auto relevant = false;
+
+          size_t offset = 0;
+          while (offset + sizeof(inotify_event) <= bytes_transferred) {
+            inotify_event e;
+            std::memcpy(&e, buffer_.data() + offset, sizeof(e));
+
+            if (e.len == 0) {
+              // Events of the file itself. (or the parent directory itself)
+              relevant = true;
+            } else {
+              auto name = reinterpret_cast<const char*>(buffer_.data() + offset + sizeof(inotify_event));
+              if (file_name_ == name) {
+                relevant = true;
+              }
+            }
+
+            offset += sizeof(inotify_event) + e.len;
+          }
+
+          // Continue reading before calling `changed` since `changed` might destroy the watcher.
+          async_read();
+
+          if (relevant && changed_) {
+            // Copy `changed_` since `changed` might destroy the watcher.
+            auto changed = changed_;
+            changed();
+          }
+        });
+  }
+
+  asio::posix::stream_descriptor descriptor_;
+  std::string file_name_;
+  std::function<void()> changed_;
+  alignas(inotify_event) std::array<uint8_t, 4096> buffer_;
+#else
+  socket_file_watcher(asio::io_context& io_ctx,
+                      const std::filesystem::path& path,
+                      std::function<void()> changed) {
+  }
+
+  [[nodiscard]] bool watching() const {
+    return false;
+  }
+#endif
+};
+} // namespace pqrs::local_datagram::impl
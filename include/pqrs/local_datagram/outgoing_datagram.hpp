@@ -0,0 +1,36 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+#include "impl/asio_helper.hpp"
+#include <pqrs/gsl.hpp>
+#include <span>
+
+namespace pqrs::local_datagram {
+
+// A datagram passed to `server::async_send_batch`.
+// `payload` is not owned. (It is copied in `async_send_batch`.)
+class outgoing_datagram final {
+public:
+  outgoing_datagram(std::span<const uint8_t> payload,
+                    not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint)
+      : payload_(payload),
+        destination_endpoint_(destination_endpoint) {
+  }
+
+  [[nodiscard]] std::span<const uint8_t> get_payload() const {
+    return payload_;
+  }
+
+  [[nodiscard]] not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> get_destination_endpoint() const {
+    return destination_endpoint_;
+  }
+
+private:
+  std::span<const uint8_t> payload_;
+  not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint_;
+};
+
+} // namespace pqrs::local_datagram
@@ -0,0 +1,37 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+#include "impl/asio_helper.hpp"
+#include <pqrs/gsl.hpp>
+#include <vector>
+
+namespace pqrs::local_datagram {
+
+// A datagram delivered through `received_batch`.
+//
+// The sender endpoint is shared with the library, so it is handed out as a const endpoint.
+class received_datagram final {
+public:
+  received_datagram(not_null_shared_ptr_t<std::vector<uint8_t>> buffer,
+                    not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> sender_endpoint)
+      : buffer_(buffer),
+        sender_endpoint_(sender_endpoint) {
+  }
+
+  [[nodiscard]] not_null_shared_ptr_t<std::vector<uint8_t>> get_buffer() const {
+    return buffer_;
+  }
+
+  [[nodiscard]] not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> get_sender_endpoint() const {
+    return sender_endpoint_;
+  }
+
+private:
+  not_null_shared_ptr_t<std::vector<uint8_t>> buffer_;
+  not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> sender_endpoint_;
+};
+
+} // namespace pqrs::local_datagram
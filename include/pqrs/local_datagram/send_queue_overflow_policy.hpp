@@ -0,0 +1,22 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdint>
+
+namespace pqrs::local_datagram {
+
+// The behavior when `async_send` is called while the send queue is full.
+// `processed` of the dropped entry is called in all policies.
+enum class send_queue_overflow_policy : uint8_t {
+  // Drop the new entry.
+  drop_newest,
+  // Drop the oldest entries which are not being sent in order to make room for the new entry.
+  drop_oldest,
+  // Drop the new entry and report `asio::error::no_buffer_space` by `error_occurred`.
+  reject_with_error,
+};
+
+} // namespace pqrs::local_datagram
@@ -0,0 +1,34 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2026.
+// Distributed under the Boost Software License, Version 1.0.
+// (See https://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdint>
+
+namespace pqrs::local_datagram {
+
+// The result of `async_send` which is reported by `std::future<send_status>`.
+enum class send_status : uint8_t {
+  // The data is sent.
+  sent,
+  // The data is dropped since it is larger than the buffer of the peer.
+  dropped_message_size,
+  // The data is dropped since `send` returns no_buffer_space error too many times.
+  dropped_no_buffer_space,
+  // The data is dropped by the send queue limit.
+  dropped_send_queue_overflow,
+  // The data is dropped since it is not sent within the send entry time to live.
+  expired,
+  // The data is not sent since the connection is closed.
+  // (In server mode, the destination client is closed.)
+  closed,
+};
+
+// Pass `use_future` to `async_send` in order to receive `send_status` by `std::future`.
+struct use_future_t final {
+};
+
+inline constexpr use_future_t use_future{};
+
+} // namespace pqrs::local_datagram
@@ -7,9 +7,12 @@
 // `pqrs::local_datagram::server` can be used safely in a multi-threaded environment.
 
 #include "impl/server_impl.hpp"
+#include "outgoing_datagram.hpp"
+#include <concepts>
 #include <filesystem>
 #include <nod/nod.hpp>
 #include <pqrs/dispatcher.hpp>
+#include <type_traits>
 
 namespace pqrs::local_datagram {
 class server final : public dispatcher::extra::dispatcher_client {
@@ -20,10 +23,21 @@ public:
   nod::signal<void()> bound;
   nod::signal<void(const asio::error_code&)> bind_failed;
   nod::signal<void()> closed;
+  // The same `sender_endpoint` instance is passed for datagrams from the same sender while the instance is referenced.
+  // Thus, senders can be compared by pointer.
+  // The instance is shared with the library (e.g., heartbeat tracking and replies), so slots must not modify it.
   nod::signal<void(not_null_shared_ptr_t<std::vector<uint8_t>>,
                    not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint>)>
       received;
+  // `received_batch` is emitted instead of `received` when `set_receive_batch_size` is specified.
+  // `received_datagram::get_sender_endpoint` returns the same shared instance as `received` as a const endpoint.
+  nod::signal<void(not_null_shared_ptr_t<std::vector<received_datagram>>)> received_batch;
+  // `sender_endpoint` is the same shared instance as `received`. Slots must not modify it.
   nod::signal<void(not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint> sender_endpoint)> next_heartbeat_deadline_exceeded;
+  nod::signal<void(const asio::error_code&)> error_occurred;
+  nod::signal<void()> send_queue_high_watermark;
+  nod::signal<void()> send_queue_low_watermark;
+  nod::signal<void(size_t)> send_entry_expired;
 
   // Methods
 
@@ -34,7 +48,35 @@ public:
          size_t buffer_size) : dispatcher_client(weak_dispatcher),
                                server_socket_file_path_(server_socket_file_path),
                                buffer_size_(buffer_size),
-                               server_send_entries_(std::make_shared<std::deque<not_null_shared_ptr_t<impl::send_entry>>>()),
+                               receive_buffer_pool_size_(impl::base_impl::default_receive_buffer_pool_size),
+                               send_queue_overflow_policy_(send_queue_overflow_policy::drop_newest),
+                               send_queue_low_watermark_(0),
+                               no_buffer_space_unsent_entry_retry_limit_(impl::base_impl::default_no_buffer_space_unsent_entry_retry_limit),
+                               no_buffer_space_retry_limit_(impl::base_impl::default_no_buffer_space_retry_limit),
+                               send_deadline_(impl::base_impl::default_send_deadline),
+                               user_data_as_heartbeat_(false),
+                               socket_file_watch_(false),
+                               server_send_entries_(std::make_shared<impl::send_queue>()),
+                               send_handoff_queue_(std::make_shared<impl::send_handoff_queue>([this](auto&& entry) {
+                                 //
+                                 // Call `processed` since there is no impl which sends the entry.
+                                 //
+
+                                 if (auto&& processed = entry->get_processed()) {
+                                   enqueue_to_dispatcher([processed] {
+                                     processed();
+                                   });
+                                 }
+
+                                 entry->finish_batch_completions([this](auto&& processed) {
+                                   enqueue_to_dispatcher([processed] {
+                                     processed();
+                                   });
+                                 });
+                               })),
+                               receive_channel_(std::make_shared<impl::receive_channel>()),
+                               send_entry_pool_(std::make_shared<impl::send_entry_pool>(impl::base_impl::default_send_entry_inline_payload_size,
+                                                                                        impl::base_impl::default_send_entry_pool_size)),
                                reconnect_timer_(*this) {
   }
 
@@ -49,6 +91,128 @@ public:
     server_check_interval_ = value;
   }
 
+  // Detect the removal of the server socket file by inotify immediately. (Linux only)
+  // `set_server_check_interval` is still used as a fallback.
+  //
+  // You have to call `set_socket_file_watch` before `async_start`.
+  void set_socket_file_watch(bool value) {
+    socket_file_watch_ = value;
+  }
+
+  // Received data is emitted by `received_batch` instead of `received` if `value` != std::nullopt.
+  //
+  // You have to call `set_receive_batch_size` before `async_start`.
+  void set_receive_batch_size(std::optional<size_t> value) {
+    receive_batch_size_ = value;
+  }
+
+  // You have to call `set_receive_buffer_pool_size` before `async_start`.
+  void set_receive_buffer_pool_size(size_t value) {
+    receive_buffer_pool_size_ = value;
+  }
+
+  // You have to call `set_send_batch_size` before `async_start`.
+  void set_send_batch_size(std::optional<size_t> value) {
+    send_batch_size_ = value;
+  }
+
+  // Limit the send queue by the number of entries and the total bytes.
+  // The send queue is unlimited by default.
+  //
+  // You have to call `set_send_queue_limit` before `async_start`.
+  void set_send_queue_limit(std::optional<size_t> max_entry_count,
+                            std::optional<size_t> max_bytes,
+                            send_queue_overflow_policy policy) {
+    send_queue_max_entry_count_ = max_entry_count;
+    send_queue_max_bytes_ = max_bytes;
+    send_queue_overflow_policy_ = policy;
+  }
+
+  // You have to call `set_send_queue_watermarks` before `async_start`.
+  void set_send_queue_watermarks(std::optional<size_t> high_watermark,
+                                 size_t low_watermark) {
+    send_queue_high_watermark_ = high_watermark;
+    send_queue_low_watermark_ = low_watermark;
+  }
+
+  // Coalesce small user data into a batch datagram if `linger_window` != std::nullopt.
+  // The first entry of the batch waits `linger_window` in order to coalesce following user data.
+  // Batches are sent only to clients which announced that they accept batches.
+  // (A client announces it after it is connected if the client has `client_socket_file_path`.)
+  // Other clients receive user data one by one.
+  //
+  // You have to call `set_send_coalescing` before `async_start`.
+  void set_send_coalescing(std::optional<std::chrono::microseconds> linger_window) {
+    send_coalescing_linger_window_ = linger_window;
+  }
+
+  // The connection is closed if sending an entry is not finished within `value`.
+  // (The send deadline is checked only in client mode.)
+  //
+  // You have to call `set_send_deadline` before `async_start`.
+  void set_send_deadline(std::chrono::milliseconds value) {
+    send_deadline_ = value;
+  }
+
+  // Treat user data from a client which has an active `next_heartbeat_deadline` as a heartbeat.
+  // (The client can skip heartbeats while it sends user data by `set_user_data_as_heartbeat`.)
+  //
+  // You have to call `set_user_data_as_heartbeat` before `async_start`.
+  void set_user_data_as_heartbeat(bool value) {
+    user_data_as_heartbeat_ = value;
+  }
+
+  // Drop entries which are not sent within `value` after `async_send` is called.
+  // `send_entry_expired` is emitted with the number of dropped entries.
+  // (Entries never expire if `value` == std::nullopt.)
+  // `async_send` with `time_to_live` overrides `value` for each entry.
+  //
+  // You have to call `set_send_entry_time_to_live` before `async_send`.
+  void set_send_entry_time_to_live(std::optional<std::chrono::milliseconds> value) {
+    send_entry_time_to_live_ = value;
+  }
+
+  // Set how many times sending an entry is retried when `send` returns no_buffer_space error.
+  // The defaults are 10 times for entries which are not sent at all and 100 times for the others.
+  //
+  // You have to call `set_no_buffer_space_retry_limits` before `async_start`.
+  void set_no_buffer_space_retry_limits(size_t unsent_entry_retry_limit,
+                                        size_t retry_limit) {
+    no_buffer_space_unsent_entry_retry_limit_ = unsent_entry_retry_limit;
+    no_buffer_space_retry_limit_ = retry_limit;
+  }
+
+  // Set the maximum number of pooled send entries and the maximum payload size which is stored in the pooled entry.
+  // Send entries are allocated from the heap if `value` == 0.
+  //
+  // You have to call `set_send_entry_pool_size` before `async_start` and `async_send`.
+  void set_send_entry_pool_size(size_t value,
+                                size_t inline_payload_size = impl::base_impl::default_send_entry_inline_payload_size) {
+    send_entry_pool_ = std::make_shared<impl::send_entry_pool>(inline_payload_size,
+                                                               value);
+  }
+
+  // Deliver received data by `async_receive` instead of `received` and `received_batch` if `value` != std::nullopt.
+  // Reading the socket is paused while `value` datagrams are not taken by `async_receive`.
+  //
+  // You have to call `set_receive_queue_capacity` before `async_start`.
+  void set_receive_queue_capacity(std::optional<size_t> value) {
+    receive_queue_capacity_ = value;
+    if (value) {
+      receive_channel_->set_capacity(*value);
+    }
+  }
+
+  // Set a handler which is called in the internal io thread for each received data instead of `received` and `received_batch`.
+  // The handler receives borrowed views which are valid only while the handler is running.
+  // The handler should return quickly because it blocks receiving the following data.
+  //
+  // You have to call `set_inline_received_handler` before `async_start`.
+  void set_inline_received_handler(std::function<void(std::span<const uint8_t> buffer,
+                                                      const asio::local::datagram_protocol::endpoint& sender_endpoint)> value) {
+    inline_received_handler_ = value;
+  }
+
   // You have to call `set_reconnect_interval` before `async_start`.
   void set_reconnect_interval(std::optional<std::chrono::milliseconds> value) {
     reconnect_interval_ = value;
@@ -67,25 +231,189 @@ public:
   }
 
   void async_send(const std::vector<uint8_t>& v,
-                  not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint> destination_endpoint,
+                  not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
                   std::function<void()> processed = nullptr) {
-    auto entry = std::make_shared<impl::send_entry>(impl::send_entry::type::user_data,
-                                                    v,
-                                                    destination_endpoint,
-                                                    processed);
+    auto entry = send_entry_pool_->copy_entry(impl::send_entry::type::user_data,
+                                              v,
+                                              destination_endpoint,
+                                              processed);
+    async_send(entry);
+  }
+
+  // `v` is moved to the send queue without copying.
+  void async_send(std::vector<uint8_t>&& v,
+                  not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                  std::function<void()> processed = nullptr) {
+    auto entry = send_entry_pool_->make_entry(impl::send_entry::type::user_data,
+                                              std::move(v),
+                                              destination_endpoint,
+                                              processed);
     async_send(entry);
   }
 
   void async_send(const uint8_t* p,
                   size_t length,
-                  not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint> destination_endpoint,
+                  not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                  std::function<void()> processed = nullptr) {
+    auto entry = send_entry_pool_->copy_entry(impl::send_entry::type::user_data,
+                                              std::span<const uint8_t>(p, p ? length : 0),
+                                              destination_endpoint,
+                                              processed);
+    async_send(entry);
+  }
+
+  // `v` is sent without copying.
+  void async_send(not_null_shared_ptr_t<const std::vector<uint8_t>> v,
+                  not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
                   std::function<void()> processed = nullptr) {
-    auto entry = std::make_shared<impl::send_entry>(impl::send_entry::type::user_data,
-                                                    p,
-                                                    length,
-                                                    destination_endpoint,
-                                                    processed);
+    auto entry = send_entry_pool_->make_entry(impl::send_entry::type::user_data,
+                                              v,
+                                              destination_endpoint,
+                                              processed);
+    async_send(entry);
+  }
+
+  // `payload` is sent without copying.
+  // `payload_owner` keeps `payload` alive until `payload` is sent.
+  void async_send(std::span<const uint8_t> payload,
+                  std::shared_ptr<const void> payload_owner,
+                  not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                  std::function<void()> processed = nullptr) {
+    auto entry = send_entry_pool_->make_entry(impl::send_entry::type::user_data,
+                                              payload,
+                                              payload_owner,
+                                              destination_endpoint,
+                                              processed);
+    async_send(entry);
+  }
+
+  // `v` is dropped if it is not sent within `time_to_live`.
+  // (`time_to_live` overrides `set_send_entry_time_to_live`.)
+  void async_send(const std::vector<uint8_t>& v,
+                  not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                  std::chrono::milliseconds time_to_live,
+                  std::function<void()> processed = nullptr) {
+    auto entry = send_entry_pool_->copy_entry(impl::send_entry::type::user_data,
+                                              v,
+                                              destination_endpoint,
+                                              processed);
+    entry->set_deadline(impl::asio_helper::time_point::now() + time_to_live);
+    async_send(entry);
+  }
+
+  // `v` is moved to the send queue without copying.
+  void async_send(std::vector<uint8_t>&& v,
+                  not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                  std::chrono::milliseconds time_to_live,
+                  std::function<void()> processed = nullptr) {
+    auto entry = send_entry_pool_->make_entry(impl::send_entry::type::user_data,
+                                              std::move(v),
+                                              destination_endpoint,
+                                              processed);
+    entry->set_deadline(impl::asio_helper::time_point::now() + time_to_live);
+    async_send(entry);
+  }
+
+  // The returned future receives `send_status` when `v` is sent or dropped.
+  // (`use_future` does not allocate `std::function` for the completion.)
+  [[nodiscard]] std::future<send_status> async_send(const std::vector<uint8_t>& v,
+                                                    not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                                                    use_future_t) {
+    auto entry = send_entry_pool_->copy_entry(impl::send_entry::type::user_data,
+                                              v,
+                                              destination_endpoint);
+    auto future = entry->make_future();
+    async_send(entry);
+    return future;
+  }
+
+  // `v` is moved to the send queue without copying.
+  [[nodiscard]] std::future<send_status> async_send(std::vector<uint8_t>&& v,
+                                                    not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                                                    use_future_t) {
+    auto entry = send_entry_pool_->make_entry(impl::send_entry::type::user_data,
+                                              std::move(v),
+                                              destination_endpoint);
+    auto future = entry->make_future();
+    async_send(entry);
+    return future;
+  }
+
+  // `payload` is sent without copying.
+  // `payload_owner` keeps `payload` alive until `payload` is sent.
+  [[nodiscard]] std::future<send_status> async_send(std::span<const uint8_t> payload,
+                                                    std::shared_ptr<const void> payload_owner,
+                                                    not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                                                    use_future_t) {
+    auto entry = send_entry_pool_->make_entry(impl::send_entry::type::user_data,
+                                              payload,
+                                              payload_owner,
+                                              destination_endpoint);
+    auto future = entry->make_future();
     async_send(entry);
+    return future;
+  }
+
+  // Receive data with a completion token. (e.g., `co_await server.async_receive(asio::use_awaitable)`)
+  // The completion signature is `void(asio::error_code, received_datagram)`.
+  // The handler is called in the executor associated with the token. (asio's system executor if no executor is associated.)
+  // `asio::error::in_progress` is reported if `async_receive` is called while the previous call is waiting.
+  //
+  // `set_receive_queue_capacity` is required.
+  template <typename CompletionToken>
+  auto async_receive(CompletionToken&& token) {
+    return receive_channel_->async_receive(std::forward<CompletionToken>(token));
+  }
+
+  // Send `v` with a completion token. (e.g., `co_await server.async_send(v, asio::use_awaitable)`)
+  // The completion signature is `void(send_status)`.
+  template <typename CompletionToken>
+    requires(!std::is_convertible_v<CompletionToken, std::function<void()>> &&
+             !std::is_convertible_v<CompletionToken, std::chrono::milliseconds> &&
+             !std::same_as<std::decay_t<CompletionToken>, use_future_t>)
+  auto async_send(const std::vector<uint8_t>& v,
+                  not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                  CompletionToken&& token) {
+    return async_send(send_entry_pool_->copy_entry(impl::send_entry::type::user_data,
+                                                   v,
+                                                   destination_endpoint),
+                      std::forward<CompletionToken>(token));
+  }
+
+  // `v` is moved to the send queue without copying.
+  template <typename CompletionToken>
+    requires(!std::is_convertible_v<CompletionToken, std::function<void()>> &&
+             !std::is_convertible_v<CompletionToken, std::chrono::milliseconds> &&
+             !std::same_as<std::decay_t<CompletionToken>, use_future_t>)
+  auto async_send(std::vector<uint8_t>&& v,
+                  not_null_shared_ptr_t<const asio::local::datagram_protocol::endpoint> destination_endpoint,
+                  CompletionToken&& token) {
+    return async_send(send_entry_pool_->make_entry(impl::send_entry::type::user_data,
+                                                   std::move(v),
+                                                   destination_endpoint),
+                      std::forward<CompletionToken>(token));
+  }
+
+  // Send `messages` as a single unit.
+  // All messages are passed to the send queue at once and `processed` is called once after all messages are processed.
+  void async_send_batch(std::span<const outgoing_datagram> messages,
+                        std::function<void()> processed = nullptr) {
+    auto completion = make_send_batch_completion(messages.size(),
+                                                 processed);
+
+    std::vector<not_null_shared_ptr_t<impl::send_entry>> entries;
+    entries.reserve(messages.size());
+    for (const auto& m : messages) {
+      entries.push_back(send_entry_pool_->copy_entry(impl::send_entry::type::user_data,
+                                                     m.get_payload(),
+                                                     m.get_destination_endpoint(),
+                                                     nullptr));
+      if (completion) {
+        entries.back()->add_batch_completion(completion);
+      }
+    }
+
+    async_send(entries);
   }
 
 private:
@@ -105,49 +433,79 @@ private:
 
     server_impl_ = std::make_unique<impl::server_impl>(weak_dispatcher_,
                                                        server_send_entries_);
+    server_impl_->attach_send_handoff_queue(send_handoff_queue_);
+
+    // `server_impl_` signals are invoked from the dispatcher thread, so we emit our signals directly.
+    // Our signals are emitted at the end of each handler because a slot might destroy `this`.
 
     server_impl_->warning_reported.connect([this](auto&& message) {
-      enqueue_to_dispatcher([this, message] {
-        warning_reported(message);
-      });
+      warning_reported(message);
     });
 
     server_impl_->bound.connect([this] {
-      enqueue_to_dispatcher([this] {
-        bound();
-      });
+      bound();
     });
 
     server_impl_->bind_failed.connect([this](auto&& error_code) {
-      enqueue_to_dispatcher([this, error_code] {
-        bind_failed(error_code);
-      });
-
       close();
       start_reconnect_timer();
-    });
 
-    server_impl_->closed.connect([this] {
-      enqueue_to_dispatcher([this] {
-        closed();
-      });
+      bind_failed(error_code);
+    });
 
+    server_impl_->closed.connect([this](auto&& socket_file_removed) {
       close();
-      start_reconnect_timer();
+      // Bind again immediately if the socket file is removed.
+      start_reconnect_timer(socket_file_removed);
+
+      closed();
     });
 
     server_impl_->received.connect([this](auto&& buffer, auto&& sender_endpoint) {
-      enqueue_to_dispatcher([this, buffer, sender_endpoint] {
-        received(buffer, sender_endpoint);
-      });
+      received(buffer, sender_endpoint);
+    });
+
+    server_impl_->received_batch.connect([this](auto&& batch) {
+      received_batch(batch);
     });
 
     server_impl_->next_heartbeat_deadline_exceeded.connect([this](auto&& sender_endpoint) {
-      enqueue_to_dispatcher([this, sender_endpoint] {
-        next_heartbeat_deadline_exceeded(sender_endpoint);
-      });
+      next_heartbeat_deadline_exceeded(sender_endpoint);
+    });
+
+    server_impl_->error_occurred.connect([this](auto&& error_code) {
+      error_occurred(error_code);
+    });
+
+    server_impl_->send_queue_high_watermark.connect([this] {
+      send_queue_high_watermark();
+    });
+
+    server_impl_->send_queue_low_watermark.connect([this] {
+      send_queue_low_watermark();
     });
 
+    server_impl_->send_entry_expired.connect([this](auto&& count) {
+      send_entry_expired(count);
+    });
+
+    server_impl_->set_receive_batch_size(receive_batch_size_);
+    server_impl_->set_receive_buffer_pool_size(receive_buffer_pool_size_);
+    server_impl_->set_send_batch_size(send_batch_size_);
+    server_impl_->set_send_queue_limit(send_queue_max_entry_count_,
+                                       send_queue_max_bytes_,
+                                       send_queue_overflow_policy_);
+    server_impl_->set_send_queue_watermarks(send_queue_high_watermark_,
+                                            send_queue_low_watermark_);
+    server_impl_->set_send_coalescing(send_coalescing_linger_window_);
+    server_impl_->set_send_deadline(send_deadline_);
+    server_impl_->set_user_data_as_heartbeat(user_data_as_heartbeat_);
+    server_impl_->set_socket_file_watch(socket_file_watch_);
+    server_impl_->set_no_buffer_space_retry_limits(no_buffer_space_unsent_entry_retry_limit_,
+                                                   no_buffer_space_retry_limit_);
+    server_impl_->set_inline_received_handler(inline_received_handler_);
+    server_impl_->set_receive_channel(receive_queue_capacity_ ? receive_channel_.get() : nullptr);
+
     server_impl_->async_bind(server_socket_file_path_,
                              buffer_size_,
                              server_check_interval_);
@@ -160,10 +518,14 @@ private:
     }
 
     server_impl_ = nullptr;
+
+    send_handoff_queue_->detach();
   }
 
+  // The first bind is tried without waiting `reconnect_interval_` if `immediately` is true.
+  //
   // This method is executed in the dispatcher thread.
-  void start_reconnect_timer() {
+  void start_reconnect_timer(bool immediately = false) {
     if (reconnect_interval_) {
       enqueue_to_dispatcher(
           [this] {
@@ -177,36 +539,91 @@ private:
                 },
                 *reconnect_interval_);
           },
-          when_now() + *reconnect_interval_);
+          immediately ? when_now() : when_now() + *reconnect_interval_);
     } else {
       reconnect_timer_.stop();
     }
   }
 
   void async_send(not_null_shared_ptr_t<impl::send_entry> entry) {
-    enqueue_to_dispatcher([this, entry] {
-      if (server_impl_) {
-        server_impl_->async_send(entry);
-      } else {
-        //
-        // Call `processed`
-        //
-
-        auto&& processed = entry->get_processed();
-        if (processed) {
-          enqueue_to_dispatcher([processed] {
-            processed();
-          });
-        }
+    // Keep the deadline which is specified by `async_send` with `time_to_live`.
+    if (send_entry_time_to_live_ &&
+        !entry->get_deadline()) {
+      entry->set_deadline(impl::asio_helper::time_point::now() + *send_entry_time_to_live_);
+    }
+
+    // The entry is passed to `io_ctx_thread_` directly without the dispatcher.
+    send_handoff_queue_->push(entry);
+  }
+
+  template <typename CompletionToken>
+  auto async_send(not_null_shared_ptr_t<impl::send_entry> entry,
+                  CompletionToken&& token) {
+    return asio::async_initiate<CompletionToken, void(send_status)>(
+        [this, entry](auto handler) {
+          entry->add_completion_handler(std::move(handler));
+          async_send(entry);
+        },
+        token);
+  }
+
+  void async_send(const std::vector<not_null_shared_ptr_t<impl::send_entry>>& entries) {
+    if (send_entry_time_to_live_) {
+      auto deadline = impl::asio_helper::time_point::now() + *send_entry_time_to_live_;
+      for (const auto& e : entries) {
+        e->set_deadline(deadline);
       }
-    });
+    }
+
+    send_handoff_queue_->push_all(entries);
+  }
+
+  // Returns a completion which hands out `processed` when `count` entries are finished.
+  // (`processed` is called immediately if `count` == 0.)
+  std::shared_ptr<impl::send_batch_completion> make_send_batch_completion(size_t count,
+                                                                          std::function<void()> processed) {
+    if (!processed) {
+      return nullptr;
+    }
+
+    if (count == 0) {
+      enqueue_to_dispatcher([processed] {
+        processed();
+      });
+      return nullptr;
+    }
+
+    return std::make_shared<impl::send_batch_completion>(count,
+                                                         processed);
   }
 
   std::filesystem::path server_socket_file_path_;
   size_t buffer_size_;
   std::optional<std::chrono::milliseconds> server_check_interval_;
   std::optional<std::chrono::milliseconds> reconnect_interval_;
-  not_null_shared_ptr_t<std::deque<not_null_shared_ptr_t<impl::send_entry>>> server_send_entries_;
+  std::optional<size_t> receive_batch_size_;
+  size_t receive_buffer_pool_size_;
+  std::optional<size_t> send_batch_size_;
+  std::optional<size_t> send_queue_max_entry_count_;
+  std::optional<size_t> send_queue_max_bytes_;
+  send_queue_overflow_policy send_queue_overflow_policy_;
+  std::optional<size_t> send_queue_high_watermark_;
+  size_t send_queue_low_watermark_;
+  size_t no_buffer_space_unsent_entry_retry_limit_;
+  size_t no_buffer_space_retry_limit_;
+  std::optional<std::chrono::microseconds> send_coalescing_linger_window_;
+  std::chrono::milliseconds send_deadline_;
+  std::optional<std::chrono::milliseconds> send_entry_time_to_live_;
+  std::optional<size_t> receive_queue_capacity_;
+  bool user_data_as_heartbeat_;
+  bool socket_file_watch_;
+  std::function<void(std::span<const uint8_t> buffer,
+                     const asio::local::datagram_protocol::endpoint& sender_endpoint)>
+      inline_received_handler_;
+  not_null_shared_ptr_t<impl::send_queue> server_send_entries_;
+  not_null_shared_ptr_t<impl::send_handoff_queue> send_handoff_queue_;
+  not_null_shared_ptr_t<impl::receive_channel> receive_channel_;
+  not_null_shared_ptr_t<impl::send_entry_pool> send_entry_pool_;
   std::unique_ptr<impl::server_impl> server_impl_;
   dispatcher::extra::timer reconnect_timer_;
 };
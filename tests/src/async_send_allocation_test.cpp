@@ -0,0 +1,149 @@
+#include "test.hpp"
+#include <atomic>
+#include <boost/ut.hpp>
+#include <cstdlib>
+#include <new>
+
+//
+// Count payload allocations in order to confirm payloads are not copied between the caller and the kernel.
+//
+// This test is built as a separate executable since it replaces the global `operator new`.
+//
+
+namespace async_send_allocation_test {
+constexpr size_t payload_size = 4099;
+
+// Allocations are counted only in the thread which calls `async_send` while `counting` is true.
+thread_local bool counting = false;
+thread_local size_t payload_allocation_count = 0;
+} // namespace async_send_allocation_test
+
+// `noinline` prevents `-Wmismatched-new-delete` false positives.
+[[gnu::noinline]] void* operator new(size_t size) {
+  // Payload copies are not smaller than the payload.
+  if (async_send_allocation_test::counting &&
+      size >= async_send_allocation_test::payload_size) {
+    ++async_send_allocation_test::payload_allocation_count;
+  }
+
+  if (auto p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+// asio allocates some objects by the nothrow version. (e.g., `asio::any_completion_executor`)
+[[gnu::noinline]] void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+int main() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  "async_send allocation count"_test = [] {
+    std::cout << "TEST_CASE(async_send allocation count)" << std::endl;
+
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    unlink(test_constants::server_socket_file_path.c_str());
+
+    auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                 test_constants::server_socket_file_path,
+                                                                 test_constants::server_buffer_size);
+    std::atomic<size_t> received_count(0);
+
+    {
+      auto wait = pqrs::make_thread_wait();
+
+      server->bound.connect([wait] {
+        wait->notify();
+      });
+
+      server->received.connect([&received_count](auto&& buffer, auto&& sender_endpoint) {
+        if (buffer->size() == async_send_allocation_test::payload_size) {
+          ++received_count;
+        }
+      });
+
+      server->async_start();
+
+      wait->wait_notice();
+    }
+
+    auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                 test_constants::server_socket_file_path,
+                                                                 std::nullopt,
+                                                                 test_constants::server_buffer_size);
+
+    {
+      auto wait = pqrs::make_thread_wait();
+
+      client->connected.connect([wait](auto&& peer_pid) {
+        wait->notify();
+      });
+
+      client->async_start();
+
+      wait->wait_notice();
+    }
+
+    auto send = [&](auto&& f) {
+      auto wait = pqrs::make_thread_wait();
+
+      async_send_allocation_test::payload_allocation_count = 0;
+      async_send_allocation_test::counting = true;
+
+      f([wait] {
+        wait->notify();
+      });
+
+      async_send_allocation_test::counting = false;
+
+      wait->wait_notice();
+
+      return async_send_allocation_test::payload_allocation_count;
+    };
+
+    constexpr int loop_count = 10;
+
+    // Payloads are copied once with `const std::vector<uint8_t>&`.
+    for (int i = 0; i < loop_count; ++i) {
+      std::vector<uint8_t> v(async_send_allocation_test::payload_size);
+      expect(1_ul == send([&](auto&& processed) {
+               client->async_send(v, processed);
+             }));
+    }
+
+    // Payloads are not copied with `std::vector<uint8_t>&&`.
+    for (int i = 0; i < loop_count; ++i) {
+      std::vector<uint8_t> v(async_send_allocation_test::payload_size);
+      expect(0_ul == send([&](auto&& processed) {
+               client->async_send(std::move(v), processed);
+             }));
+    }
+
+    // Wait until the server receives all data.
+    for (int i = 0; i < 100 && received_count < loop_count * 2; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    expect(loop_count * 2 == received_count);
+
+    client = nullptr;
+    server = nullptr;
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  return 0;
+}
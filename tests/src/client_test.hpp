@@ -360,6 +360,170 @@ void run_client_test() {
     dispatcher = nullptr;
   };
 
+  "local_datagram::client signal order"_test = [] {
+    std::cout << "TEST_CASE(local_datagram::client signal order)" << std::endl;
+
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    {
+      const size_t count = 100;
+      std::vector<std::string> server_events;
+      std::vector<std::string> client_events;
+
+      unlink(test_constants::server_socket_file_path.c_str());
+      unlink(test_constants::client_socket_file_path.c_str());
+
+      auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+
+      server->bound.connect([&] {
+        server_events.push_back("bound");
+      });
+
+      server->received.connect([&](auto&& buffer, auto&& sender_endpoint) {
+        server_events.push_back("received " + std::to_string((*buffer)[0]));
+
+        // echo
+        server->async_send(*buffer, sender_endpoint);
+      });
+
+      server->async_start();
+
+      // Wait for a while until server is prepared
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::client_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+
+      client->connected.connect([&](auto&& peer_pid) {
+        client_events.push_back("connected");
+
+        for (size_t i = 0; i < count; ++i) {
+          client->async_send(std::vector<uint8_t>{static_cast<uint8_t>(i)});
+        }
+      });
+
+      client->received.connect([&](auto&& buffer, auto&& sender_endpoint) {
+        client_events.push_back("received " + std::to_string((*buffer)[0]));
+      });
+
+      client->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+      std::vector<std::string> expected_server_events{"bound"};
+      std::vector<std::string> expected_client_events{"connected"};
+      for (size_t i = 0; i < count; ++i) {
+        expected_server_events.push_back("received " + std::to_string(i));
+        expected_client_events.push_back("received " + std::to_string(i));
+      }
+
+      expect(server_events == expected_server_events);
+      expect(client_events == expected_client_events);
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::client send_batch"_test = [] {
+    std::cout << "TEST_CASE(local_datagram::client send_batch)" << std::endl;
+
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    {
+      const size_t count = 100;
+      const size_t send_batch_size = 16;
+      std::vector<uint8_t> server_received;
+
+      unlink(test_constants::server_socket_file_path.c_str());
+
+      auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      server->set_send_batch_size(send_batch_size);
+
+      server->received.connect([&](auto&& buffer, auto&& sender_endpoint) {
+        server_received.push_back((*buffer)[0]);
+
+        // echo
+        server->async_send(*buffer, sender_endpoint);
+      });
+
+      server->async_start();
+
+      // Wait for a while until server is prepared
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      std::vector<std::unique_ptr<pqrs::local_datagram::client>> clients;
+      std::vector<std::vector<uint8_t>> client_received(2);
+      std::vector<asio::error_code> client_error_codes(2);
+      size_t processed_count = 0;
+
+      for (const auto& path : {test_constants::client_socket_file_path,
+                               test_constants::client_socket2_file_path}) {
+        auto index = clients.size();
+
+        auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                     test_constants::server_socket_file_path,
+                                                                     path,
+                                                                     test_constants::server_buffer_size);
+        client->set_send_batch_size(send_batch_size);
+
+        client->received.connect([&, index](auto&& buffer, auto&& sender_endpoint) {
+          client_received[index].push_back((*buffer)[0]);
+        });
+
+        client->error_occurred.connect([&, index](auto&& error_code) {
+          client_error_codes[index] = error_code;
+        });
+
+        client->async_start();
+
+        clients.push_back(std::move(client));
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      for (size_t i = 0; i < count; ++i) {
+        for (auto&& c : clients) {
+          c->async_send(std::vector<uint8_t>{static_cast<uint8_t>(i)}, [&] {
+            ++processed_count;
+          });
+        }
+
+        // Entries after a too large entry are also sent.
+        if (i == count / 2) {
+          clients[0]->async_send(std::vector<uint8_t>(test_constants::server_buffer_size * 2, 0), [&] {
+            ++processed_count;
+          });
+        }
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+      std::vector<uint8_t> expected;
+      for (size_t i = 0; i < count; ++i) {
+        expected.push_back(static_cast<uint8_t>(i));
+      }
+
+      expect(server_received.size() == count * 2);
+      expect(client_received[0] == expected);
+      expect(client_received[1] == expected);
+      expect(client_error_codes[0] == asio::error::message_size);
+      expect(!client_error_codes[1]);
+      expect(processed_count == count * 2 + 1);
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
   "local_datagram::client bidirectional check_client_endpoint"_test = [] {
     std::cout << "TEST_CASE(local_datagram::client bidirectional check_client_endpoint)" << std::endl;
 
@@ -481,4 +645,646 @@ void run_client_test() {
     dispatcher->terminate();
     dispatcher = nullptr;
   };
+
+  "local_datagram::client send_queue_limit"_test = [] {
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    for (const auto& policy : {pqrs::local_datagram::send_queue_overflow_policy::drop_newest,
+                               pqrs::local_datagram::send_queue_overflow_policy::drop_oldest,
+                               pqrs::local_datagram::send_queue_overflow_policy::reject_with_error}) {
+      std::vector<int> processed_values;
+      size_t error_occurred_count = 0;
+      size_t high_watermark_count = 0;
+
+      // Entries are kept in the send queue since the server does not exist.
+      auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                   "/not_found/server_socket.sock",
+                                                                   std::nullopt,
+                                                                   test_constants::server_buffer_size);
+      client->set_send_queue_limit(3,
+                                   std::nullopt,
+                                   policy);
+      client->set_send_queue_watermarks(2,
+                                        0);
+
+      client->error_occurred.connect([&](auto&& error_code) {
+        expect(asio::error::no_buffer_space == error_code);
+        ++error_occurred_count;
+      });
+
+      client->send_queue_high_watermark.connect([&] {
+        ++high_watermark_count;
+      });
+
+      client->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      for (int i = 0; i < 5; ++i) {
+        client->async_send(std::vector<uint8_t>{static_cast<uint8_t>(i)},
+                           [&processed_values, i] {
+                             processed_values.push_back(i);
+                           });
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      switch (policy) {
+        case pqrs::local_datagram::send_queue_overflow_policy::drop_newest:
+          expect(processed_values == std::vector<int>{3, 4});
+          expect(error_occurred_count == 0);
+          break;
+        case pqrs::local_datagram::send_queue_overflow_policy::drop_oldest:
+          expect(processed_values == std::vector<int>{0, 1});
+          expect(error_occurred_count == 0);
+          break;
+        case pqrs::local_datagram::send_queue_overflow_policy::reject_with_error:
+          expect(processed_values == std::vector<int>{3, 4});
+          expect(error_occurred_count == 2);
+          break;
+      }
+      expect(high_watermark_count == 1);
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::client send_entry_time_to_live"_test = [] {
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    {
+      auto server = std::make_unique<test_server>(dispatcher,
+                                                  std::nullopt);
+
+      auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   std::nullopt,
+                                                                   test_constants::server_buffer_size);
+      // Entries are expired before they are sent.
+      client->set_send_entry_time_to_live(std::chrono::milliseconds(0));
+
+      size_t expired_count = 0;
+      client->send_entry_expired.connect([&](auto&& count) {
+        expired_count += count;
+      });
+
+      client->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      int processed_count = 0;
+      for (int i = 0; i < 3; ++i) {
+        client->async_send(std::vector<uint8_t>(8, '0'), [&] {
+          ++processed_count;
+        });
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      expect(processed_count == 3);
+      expect(expired_count == 3_ul);
+      expect(server->get_received_count() == 0_ul);
+
+      // Entries are sent if the time to live is not specified.
+      client->set_send_entry_time_to_live(std::nullopt);
+
+      client->async_send(std::vector<uint8_t>(8, '0'), [&] {
+        ++processed_count;
+      });
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      expect(processed_count == 4);
+      expect(expired_count == 3_ul);
+      expect(server->get_received_count() == 8_ul);
+
+      // The time to live of `async_send` overrides `set_send_entry_time_to_live`.
+
+      client->async_send(std::vector<uint8_t>(8, '0'),
+                         std::chrono::milliseconds(0),
+                         [&] {
+                           ++processed_count;
+                         });
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      expect(processed_count == 5);
+      expect(expired_count == 4_ul);
+      expect(server->get_received_count() == 8_ul);
+
+      client->set_send_entry_time_to_live(std::chrono::milliseconds(0));
+
+      std::vector<uint8_t> v(8, '0');
+      client->async_send(v,
+                         std::chrono::milliseconds(5000),
+                         [&] {
+                           ++processed_count;
+                         });
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      expect(processed_count == 6);
+      expect(expired_count == 4_ul);
+      expect(server->get_received_count() == 16_ul);
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::client send_coalescing"_test = [] {
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    using send_entry = pqrs::local_datagram::impl::send_entry;
+
+    // A raw socket which acts as a server in order to inspect datagrams.
+    for (bool peer_accepts_batch : {true, false}) {
+      unlink(test_constants::server_socket_file_path.c_str());
+
+      asio::io_context io_ctx;
+      asio::local::datagram_protocol::socket server_socket(io_ctx);
+      server_socket.open();
+      server_socket.bind(asio::local::datagram_protocol::endpoint(test_constants::server_socket_file_path));
+      server_socket.non_blocking(true);
+
+      auto receive_all = [&server_socket] {
+        std::vector<std::vector<uint8_t>> result;
+        std::vector<uint8_t> buffer(test_constants::server_buffer_size);
+        while (true) {
+          asio::error_code error_code;
+          auto n = server_socket.receive(asio::buffer(buffer), 0, error_code);
+          if (error_code) {
+            break;
+          }
+          result.emplace_back(std::begin(buffer), std::begin(buffer) + n);
+        }
+        return result;
+      };
+
+      auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::client_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      client->set_send_coalescing(std::chrono::milliseconds(50));
+
+      client->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+      // The client asks the server capabilities.
+
+      {
+        auto datagrams = receive_all();
+        expect(datagrams.size() == 1_ul);
+        expect(datagrams[0].size() == 7_ul);
+        expect(datagrams[0][0] == static_cast<uint8_t>(send_entry::type::capabilities));
+        expect(datagrams[0][1] == 1_u);
+        expect(datagrams[0][6] == 0_u);
+      }
+
+      if (peer_accepts_batch) {
+        std::array<uint8_t, 6> capabilities{static_cast<uint8_t>(send_entry::type::capabilities), 0};
+        uint32_t max_batch_size = test_constants::server_buffer_size;
+        memcpy(capabilities.data() + 2, &max_batch_size, sizeof(max_batch_size));
+        server_socket.send_to(asio::buffer(capabilities),
+                              asio::local::datagram_protocol::endpoint(test_constants::client_socket_file_path));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      }
+
+      int processed_count = 0;
+      for (uint8_t i = 0; i < 5; ++i) {
+        client->async_send(std::vector<uint8_t>{i}, [&] {
+          ++processed_count;
+        });
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      expect(processed_count == 5);
+
+      auto datagrams = receive_all();
+      if (peer_accepts_batch) {
+        std::vector<uint8_t> expected{static_cast<uint8_t>(send_entry::type::batch)};
+        for (uint8_t i = 0; i < 5; ++i) {
+          send_entry::batch_message_length_t length = 1;
+          auto p = reinterpret_cast<const uint8_t*>(&length);
+          expected.insert(std::end(expected), p, p + sizeof(length));
+          expected.push_back(i);
+        }
+
+        expect(datagrams.size() == 1_ul);
+        expect(datagrams.size() == 1 && datagrams[0] == expected);
+      } else {
+        // Batches are not sent to old peers.
+        expect(datagrams.size() == 5_ul);
+        for (uint8_t i = 0; i < datagrams.size(); ++i) {
+          expect(datagrams[i] == std::vector<uint8_t>{static_cast<uint8_t>(send_entry::type::user_data), i});
+        }
+      }
+
+      client = nullptr;
+    }
+
+    // Messages in batches are received one by one.
+
+    {
+      std::vector<uint8_t> received_values;
+
+      auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      server->received.connect([&](auto&& buffer, auto&& sender_endpoint) {
+        received_values.insert(std::end(received_values), std::begin(*buffer), std::end(*buffer));
+      });
+      server->async_start();
+
+      auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::client_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      client->set_send_coalescing(std::chrono::milliseconds(10));
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      client->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+      for (uint8_t i = 0; i < 100; ++i) {
+        client->async_send(std::vector<uint8_t>{i});
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      std::vector<uint8_t> expected;
+      for (uint8_t i = 0; i < 100; ++i) {
+        expected.push_back(i);
+      }
+      expect(received_values == expected);
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::client try_send"_test = [] {
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    {
+      std::vector<uint8_t> received_values;
+
+      auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      server->received.connect([&](auto&& buffer, auto&& sender_endpoint) {
+        received_values.insert(std::end(received_values), std::begin(*buffer), std::end(*buffer));
+      });
+      server->async_start();
+
+      auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   std::nullopt,
+                                                                   test_constants::server_buffer_size);
+
+      std::array<uint8_t, 1> payload{0};
+      int processed_count = 0;
+
+      // The fast path is not available before connected.
+      expect(!client->try_send(payload, [&] {
+        ++processed_count;
+      }));
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      client->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      // The fast path is available when the send queue is empty.
+      payload[0] = 1;
+      expect(client->try_send(payload, [&] {
+        ++processed_count;
+      }));
+
+      // The fast path is not used while entries are pending.
+      for (uint8_t i = 2; i < 100; ++i) {
+        client->async_send(std::vector<uint8_t>{i});
+      }
+      payload[0] = 100;
+      expect(!client->try_send(payload, [&] {
+        ++processed_count;
+      }));
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      expect(processed_count == 3);
+
+      std::vector<uint8_t> expected;
+      for (uint8_t i = 0; i <= 100; ++i) {
+        expected.push_back(i);
+      }
+      expect(received_values == expected);
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::client async_send_batch"_test = [] {
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    {
+      std::vector<pqrs::not_null_shared_ptr_t<std::vector<uint8_t>>> server_received_buffers;
+      std::vector<pqrs::not_null_shared_ptr_t<asio::local::datagram_protocol::endpoint>> server_received_sender_endpoints;
+      std::vector<uint8_t> client_received_values;
+
+      auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      server->received.connect([&](auto&& buffer, auto&& sender_endpoint) {
+        server_received_buffers.push_back(buffer);
+        server_received_sender_endpoints.push_back(sender_endpoint);
+      });
+
+      // The client does not reconnect, so wait until the server is bound.
+      {
+        auto wait = pqrs::make_thread_wait();
+
+        server->bound.connect([wait] {
+          wait->notify();
+        });
+
+        server->async_start();
+
+        wait->wait_notice();
+      }
+
+      auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::client_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      client->received.connect([&](auto&& buffer, auto&& sender_endpoint) {
+        client_received_values.insert(std::end(client_received_values), std::begin(*buffer), std::end(*buffer));
+      });
+      client->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      // client -> server
+
+      std::vector<std::vector<uint8_t>> messages;
+      for (uint8_t i = 0; i < 100; ++i) {
+        messages.push_back(std::vector<uint8_t>{i});
+      }
+
+      int client_processed_count = 0;
+      client->async_send_batch(messages, [&] {
+        ++client_processed_count;
+      });
+
+      // `processed` is called even if the batch is empty.
+      int empty_processed_count = 0;
+      client->async_send_batch(std::span<const std::vector<uint8_t>>(), [&] {
+        ++empty_processed_count;
+      });
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      expect(client_processed_count == 1);
+      expect(empty_processed_count == 1);
+
+      std::vector<uint8_t> server_received_values;
+      for (const auto& b : server_received_buffers) {
+        server_received_values.insert(std::end(server_received_values), std::begin(*b), std::end(*b));
+      }
+      std::vector<uint8_t> expected;
+      for (uint8_t i = 0; i < 100; ++i) {
+        expected.push_back(i);
+      }
+      expect(server_received_values == expected);
+
+      // server -> client
+
+      std::vector<pqrs::local_datagram::outgoing_datagram> outgoing_datagrams;
+      for (size_t i = 0; i < server_received_buffers.size(); ++i) {
+        outgoing_datagrams.emplace_back(*(server_received_buffers[i]),
+                                        server_received_sender_endpoints[i]);
+      }
+
+      int server_processed_count = 0;
+      server->async_send_batch(outgoing_datagrams, [&] {
+        ++server_processed_count;
+      });
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      expect(server_processed_count == 1);
+      expect(client_received_values == expected);
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::client use_future"_test = [] {
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    {
+      auto server = std::make_unique<test_server>(dispatcher,
+                                                  std::nullopt);
+
+      // closed
+
+      {
+        auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                     test_constants::server_socket_file_path,
+                                                                     std::nullopt,
+                                                                     test_constants::server_buffer_size);
+
+        auto future = client->async_send(std::vector<uint8_t>(8, '0'),
+                                         pqrs::local_datagram::use_future);
+
+        client = nullptr;
+
+        expect(future.get() == pqrs::local_datagram::send_status::closed);
+      }
+
+      auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   std::nullopt,
+                                                                   test_constants::server_buffer_size);
+      client->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      // sent
+
+      {
+        std::vector<uint8_t> v(8, '0');
+        auto future1 = client->async_send(v,
+                                          pqrs::local_datagram::use_future);
+        auto future2 = client->async_send(std::move(v),
+                                          pqrs::local_datagram::use_future);
+
+        expect(future1.get() == pqrs::local_datagram::send_status::sent);
+        expect(future2.get() == pqrs::local_datagram::send_status::sent);
+      }
+
+      // expired
+
+      {
+        client->set_send_entry_time_to_live(std::chrono::milliseconds(0));
+
+        auto future = client->async_send(std::vector<uint8_t>(8, '0'),
+                                         pqrs::local_datagram::use_future);
+
+        expect(future.get() == pqrs::local_datagram::send_status::expired);
+
+        client->set_send_entry_time_to_live(std::nullopt);
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      expect(server->get_received_count() == 16_ul);
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::client stalled server"_test = [] {
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    using send_entry = pqrs::local_datagram::impl::send_entry;
+    using send_status = pqrs::local_datagram::send_status;
+
+    {
+      unlink(test_constants::server_socket_file_path.c_str());
+
+      // A raw socket which acts as a server and does not read until the client fills its buffer.
+      asio::io_context io_ctx;
+      asio::local::datagram_protocol::socket server_socket(io_ctx);
+      server_socket.open();
+      server_socket.bind(asio::local::datagram_protocol::endpoint(test_constants::server_socket_file_path));
+      server_socket.set_option(asio::socket_base::receive_buffer_size(4096));
+      server_socket.non_blocking(true);
+
+      size_t received_user_data_count = 0;
+      auto receive_all = [&] {
+        std::array<uint8_t, 64> buffer;
+        while (true) {
+          asio::error_code error_code;
+          auto n = server_socket.receive(asio::buffer(buffer), 0, error_code);
+          if (error_code) {
+            break;
+          }
+          if (n > 0 && buffer[0] == static_cast<uint8_t>(send_entry::type::user_data)) {
+            ++received_user_data_count;
+          }
+        }
+      };
+
+      auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   std::nullopt,
+                                                                   test_constants::server_buffer_size);
+      client->set_no_buffer_space_retry_limits(2, 4);
+
+      std::atomic<size_t> error_occurred_count(0);
+      client->error_occurred.connect([&](auto&& error_code) {
+        if (error_code == asio::error::no_buffer_space) {
+          ++error_occurred_count;
+        }
+      });
+
+      {
+        auto wait = pqrs::make_thread_wait();
+
+        client->connected.connect([wait](auto&& peer_pid) {
+          wait->notify();
+        });
+
+        client->async_start();
+
+        wait->wait_notice();
+      }
+
+      constexpr size_t count = 100;
+      std::vector<std::future<send_status>> futures;
+      for (size_t i = 0; i < count; ++i) {
+        futures.push_back(client->async_send(std::vector<uint8_t>(32, '0'),
+                                             pqrs::local_datagram::use_future));
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+#if defined(__APPLE__)
+      // `send` returns no_buffer_space error while the server buffer is full.
+      // Entries are dropped after `unsent_entry_retry_limit` retries.
+      {
+        std::vector<send_status> statuses;
+        for (auto&& f : futures) {
+          statuses.push_back(f.get());
+        }
+
+        auto dropped = std::ranges::count(statuses, send_status::dropped_no_buffer_space);
+        expect(dropped > 0);
+        expect(static_cast<size_t>(dropped + std::ranges::count(statuses, send_status::sent)) == count);
+        expect(static_cast<size_t>(dropped) == error_occurred_count.load());
+
+        receive_all();
+        expect(received_user_data_count == count - static_cast<size_t>(dropped));
+      }
+#else
+      // Linux returns would_block to connected sockets while the server buffer is full.
+      // Entries are kept until the socket becomes writable.
+      {
+        std::vector<send_status> statuses;
+        for (auto&& f : futures) {
+          if (f.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            statuses.push_back(f.get());
+          }
+        }
+
+        expect(statuses.size() < count);
+        expect(static_cast<size_t>(std::ranges::count(statuses, send_status::sent)) == statuses.size());
+
+        // Entries are sent while the server reads.
+        for (int i = 0; i < 200 && received_user_data_count < count; ++i) {
+          receive_all();
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        expect(received_user_data_count == count);
+        for (auto&& f : futures) {
+          if (f.valid()) {
+            expect(f.get() == send_status::sent);
+          }
+        }
+        expect(error_occurred_count.load() == 0_ul);
+      }
+#endif
+
+      // The client recovers after the server drains the buffer.
+      {
+        auto future = client->async_send(std::vector<uint8_t>(32, '0'),
+                                         pqrs::local_datagram::use_future);
+        expect(future.get() == send_status::sent);
+      }
+
+      client = nullptr;
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
 }
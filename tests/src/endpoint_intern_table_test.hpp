@@ -0,0 +1,47 @@
+#include "test.hpp"
+#include <boost/ut.hpp>
+
+void run_endpoint_intern_table_test() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  "endpoint_intern_table"_test = [] {
+    pqrs::local_datagram::impl::endpoint_intern_table table;
+
+    asio::local::datagram_protocol::endpoint endpoint1("tmp/endpoint1.sock");
+    asio::local::datagram_protocol::endpoint endpoint2("tmp/endpoint2.sock");
+
+    auto e1 = table.intern(endpoint1);
+    auto e2 = table.intern(endpoint2);
+    auto e3 = table.intern(asio::local::datagram_protocol::endpoint("tmp/endpoint1.sock"));
+
+    expect(e1.get_id() != e2.get_id());
+    expect(e1.get_id() == e3.get_id());
+    expect(e1.get_endpoint() == e3.get_endpoint());
+    expect(*(e1.get_endpoint()) == endpoint1);
+    expect(*(e2.get_endpoint()) == endpoint2);
+
+    // Unnamed endpoint
+
+    auto e4 = table.intern(asio::local::datagram_protocol::endpoint());
+    auto e5 = table.intern(asio::local::datagram_protocol::endpoint());
+    expect(e4.get_id() == e5.get_id());
+    expect(e4.get_id() != e1.get_id());
+
+    expect(table.size() == 3_ul);
+
+    // Unreferenced endpoints are removed when the table grows.
+
+    e2 = e1;
+
+    for (int i = 0; i < 100; ++i) {
+      table.intern(asio::local::datagram_protocol::endpoint("tmp/endpoint_" + std::to_string(i) + ".sock"));
+    }
+
+    expect(table.size() < 100_ul);
+
+    auto e6 = table.intern(endpoint1);
+    expect(e6.get_id() == e1.get_id());
+    expect(e6.get_endpoint() == e1.get_endpoint());
+  };
+}
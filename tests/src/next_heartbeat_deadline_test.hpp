@@ -178,4 +178,89 @@ void run_next_heartbeat_deadline_test() {
     dispatcher->terminate();
     dispatcher = nullptr;
   };
+
+  "next_heartbeat_deadline (user_data_as_heartbeat)"_test = [] {
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    auto run = [&](bool server_user_data_as_heartbeat,
+                   bool client_user_data_as_heartbeat,
+                   std::chrono::milliseconds server_check_interval,
+                   auto&& f) {
+      unlink(test_constants::server_socket_file_path.c_str());
+
+      std::atomic<int> exceeded_count = 0;
+
+      auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      server->set_user_data_as_heartbeat(server_user_data_as_heartbeat);
+      server->next_heartbeat_deadline_exceeded.connect([&](auto&& sender_endpoint) {
+        ++exceeded_count;
+      });
+      server->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::client_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      client->set_server_check_interval(server_check_interval);
+      client->set_next_heartbeat_deadline(std::chrono::milliseconds(300));
+      client->set_user_data_as_heartbeat(client_user_data_as_heartbeat);
+      client->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      f(*client, exceeded_count);
+
+      client = nullptr;
+      server = nullptr;
+    };
+
+    auto send_user_data = [](auto&& client) {
+      for (int i = 0; i < 50; ++i) {
+        client.async_send(std::vector<uint8_t>{1, 2, 3});
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+    };
+
+    // The server treats user data as a heartbeat.
+    run(true,
+        false,
+        std::chrono::milliseconds(5000),
+        [&](auto&& client, auto&& exceeded_count) {
+          send_user_data(client);
+          expect(exceeded_count.load() == 0_i);
+
+          // The deadline is exceeded when user data is not sent.
+          std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+          expect(exceeded_count.load() == 1_i);
+        });
+
+    // The client does not skip heartbeats since the server does not treat user data as a heartbeat.
+    run(false,
+        true,
+        std::chrono::milliseconds(100),
+        [&](auto&& client, auto&& exceeded_count) {
+          send_user_data(client);
+          expect(exceeded_count.load() == 0_i);
+        });
+
+    // Both
+    run(true,
+        true,
+        std::chrono::milliseconds(100),
+        [&](auto&& client, auto&& exceeded_count) {
+          send_user_data(client);
+
+          // Heartbeats are sent again when user data is not sent.
+          std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+          expect(exceeded_count.load() == 0_i);
+        });
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
 }
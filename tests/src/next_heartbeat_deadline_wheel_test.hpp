@@ -0,0 +1,100 @@
+#include "test.hpp"
+#include <boost/ut.hpp>
+
+void run_next_heartbeat_deadline_wheel_test() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  using next_heartbeat_deadline_wheel = pqrs::local_datagram::impl::next_heartbeat_deadline_wheel;
+  using namespace std::chrono_literals;
+
+  auto make_endpoint = [](uint64_t id) {
+    return std::make_shared<asio::local::datagram_protocol::endpoint>("tmp/endpoint_" + std::to_string(id) + ".sock");
+  };
+
+  "next_heartbeat_deadline_wheel"_test = [&] {
+    next_heartbeat_deadline_wheel wheel;
+    auto now = pqrs::local_datagram::impl::asio_helper::time_point::now();
+
+    expect(wheel.get_next_advance_time() == std::nullopt);
+
+    wheel.set(1, make_endpoint(1), now + 100ms, 100ms);
+    wheel.set(2, make_endpoint(2), now + 50ms, 50ms);
+    wheel.set(3, make_endpoint(3), now + 5s, 5s);
+    expect(wheel.size() == 3_ul);
+    expect(*wheel.get_next_advance_time() <= now + 60ms);
+
+    std::vector<std::string> expired;
+    auto f = [&](auto&& sender_endpoint) {
+      expired.push_back(sender_endpoint->path());
+    };
+
+    wheel.advance(now + 40ms, f);
+    expect(expired.empty());
+
+    wheel.advance(now + 70ms, f);
+    expect(expired == std::vector<std::string>{"tmp/endpoint_2.sock"});
+    expect(!wheel.contains(2));
+
+    // Reset
+
+    wheel.set(1, make_endpoint(1), now + 1000ms, 1000ms);
+    wheel.advance(now + 200ms, f);
+    expect(expired.size() == 1_ul);
+
+    // Refresh
+
+    expect(*wheel.refresh(1, now + 500ms) == now + 1500ms);
+    expect(wheel.refresh(2, now + 500ms) == std::nullopt);
+
+    wheel.advance(now + 1100ms, f);
+    expect(expired.size() == 1_ul);
+
+    wheel.advance(now + 1600ms, f);
+    expect(expired == std::vector<std::string>{"tmp/endpoint_2.sock", "tmp/endpoint_1.sock"});
+
+    // Erase
+
+    wheel.erase(3);
+    expect(wheel.empty());
+    expect(wheel.get_next_advance_time() == std::nullopt);
+
+    wheel.advance(now + 10s, f);
+    expect(expired.size() == 2_ul);
+  };
+
+  "next_heartbeat_deadline_wheel many deadlines"_test = [&] {
+    constexpr auto tick = next_heartbeat_deadline_wheel::default_tick;
+
+    next_heartbeat_deadline_wheel wheel;
+    auto now = pqrs::local_datagram::impl::asio_helper::time_point::now();
+
+    // Deadlines are spread over all levels.
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> deadlines;
+    for (uint64_t i = 0; i < 2000; ++i) {
+      auto e = make_endpoint(i);
+      auto duration = std::chrono::milliseconds(i * i * 7 % 700000);
+      auto deadline = now + duration;
+      wheel.set(i, e, deadline, duration);
+      deadlines[e->path()] = deadline;
+    }
+
+    // Advance by the timer driven steps.
+
+    bool in_time = true;
+    size_t expired_count = 0;
+    while (auto t = wheel.get_next_advance_time()) {
+      wheel.advance(*t, [&](auto&& sender_endpoint) {
+        auto deadline = deadlines.at(sender_endpoint->path());
+        if (*t < deadline || deadline + tick < *t) {
+          in_time = false;
+        }
+        ++expired_count;
+      });
+    }
+
+    expect(in_time);
+    expect(expired_count == 2000_ul);
+    expect(wheel.empty());
+  };
+}
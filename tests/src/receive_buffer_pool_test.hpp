@@ -0,0 +1,63 @@
+#include "test.hpp"
+#include <boost/ut.hpp>
+
+void run_receive_buffer_pool_test() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  "receive_buffer_pool"_test = [] {
+    auto pool = std::make_shared<pqrs::local_datagram::impl::receive_buffer_pool>(1024,
+                                                                                 2);
+
+    std::vector<uint8_t> data{1, 2, 3};
+
+    const uint8_t* p1 = nullptr;
+
+    {
+      auto b1 = pool->lease(data);
+      expect(*b1 == data);
+      expect(b1->capacity() >= 1024);
+      expect(pool->get_slab_count() == 1);
+
+      p1 = b1->data();
+    }
+
+    // The slab is reused after the buffer is released.
+    {
+      auto b1 = pool->lease(std::vector<uint8_t>{4, 5});
+      expect(*b1 == std::vector<uint8_t>{4, 5});
+      expect(b1->data() == p1);
+      expect(pool->get_slab_count() == 1);
+
+      auto b2 = pool->lease(data);
+      expect(pool->get_slab_count() == 2);
+
+      // Fallback to heap allocated buffer if all slabs are in use.
+      auto b3 = pool->lease(data);
+      expect(*b3 == data);
+      expect(pool->get_slab_count() == 2);
+    }
+
+    // Release from another thread.
+    {
+      auto b1 = pool->lease(data);
+      auto b2 = pool->lease(data);
+
+      std::thread([b1, b2] {
+      }).join();
+    }
+
+    {
+      auto b1 = pool->lease(data);
+      auto b2 = pool->lease(data);
+      expect(pool->get_slab_count() == 2);
+    }
+
+    // Buffers can outlive the pool.
+    {
+      auto b1 = pool->lease(data);
+      pool = nullptr;
+      expect(*b1 == data);
+    }
+  };
+}
@@ -0,0 +1,93 @@
+#include "test.hpp"
+#include <boost/ut.hpp>
+
+void run_send_entry_pool_test() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  using send_entry = pqrs::local_datagram::impl::send_entry;
+
+  "send_entry_pool"_test = [] {
+    auto pool = std::make_shared<pqrs::local_datagram::impl::send_entry_pool>(4,
+                                                                             2);
+
+    std::vector<uint8_t> data{1, 2, 3};
+
+    const void* p1 = nullptr;
+
+    {
+      auto e1 = pool->copy_entry(send_entry::type::user_data, data, nullptr);
+      expect(e1->size() == 4_ul);
+      expect(e1->make_buffers()[1].data() != data.data());
+      expect(pool->get_slab_count() == 1);
+
+      p1 = e1->make_buffers()[1].data();
+    }
+
+    // The slab is reused after the entry is released.
+    {
+      auto e1 = pool->copy_entry(send_entry::type::user_data, std::vector<uint8_t>{4, 5}, nullptr);
+      expect(e1->make_buffers()[1].data() == p1);
+      expect(e1->size() == 3_ul);
+      expect(pool->get_slab_count() == 1);
+
+      auto e2 = pool->make_entry(send_entry::type::user_data, std::vector<uint8_t>(1024), nullptr);
+      expect(e2->size() == 1025_ul);
+      expect(pool->get_slab_count() == 2);
+
+      // Fallback to heap allocated entry if all slabs are in use.
+      auto e3 = pool->copy_entry(send_entry::type::user_data, data, nullptr);
+      expect(e3->size() == 4_ul);
+      expect(pool->get_slab_count() == 2);
+    }
+
+    // Fallback to heap allocated entry if the payload exceeds `inline_payload_size`.
+    {
+      auto e1 = pool->copy_entry(send_entry::type::user_data, std::vector<uint8_t>(5), nullptr);
+      expect(e1->size() == 6_ul);
+
+      auto e2 = pool->copy_entry(send_entry::type::user_data, data, nullptr);
+      expect(e2->make_buffers()[1].data() == p1);
+    }
+
+    // Entries can outlive the pool.
+    {
+      auto e1 = pool->copy_entry(send_entry::type::user_data, data, nullptr);
+      pool = nullptr;
+      expect(e1->size() == 4_ul);
+    }
+  };
+
+  "send_entry_pool multi-threaded"_test = [] {
+    auto pool = std::make_shared<pqrs::local_datagram::impl::send_entry_pool>(8,
+                                                                             4);
+
+    std::atomic<bool> corrupted = false;
+    std::vector<std::thread> threads;
+    for (uint8_t t = 0; t < 4; ++t) {
+      threads.emplace_back([pool, t, &corrupted] {
+        std::vector<uint8_t> data(8, t);
+
+        for (int i = 0; i < 10000; ++i) {
+          auto e1 = pool->copy_entry(send_entry::type::user_data, data, nullptr);
+          auto e2 = pool->copy_entry(send_entry::type::user_data, data, nullptr);
+
+          for (const auto& e : {e1, e2}) {
+            auto buffer = e->make_buffers()[1];
+            if (buffer.size() != data.size() ||
+                std::memcmp(buffer.data(), data.data(), data.size()) != 0) {
+              corrupted = true;
+            }
+          }
+        }
+      });
+    }
+
+    for (auto&& t : threads) {
+      t.join();
+    }
+
+    expect(!corrupted);
+    expect(pool->get_slab_count() <= 4_ul);
+  };
+}
@@ -0,0 +1,120 @@
+#include "test.hpp"
+#include <boost/ut.hpp>
+
+namespace {
+std::vector<uint8_t> flatten(const std::array<asio::const_buffer, 2>& buffers) {
+  std::vector<uint8_t> result;
+  for (const auto& b : buffers) {
+    auto p = static_cast<const uint8_t*>(b.data());
+    result.insert(std::end(result), p, p + b.size());
+  }
+  return result;
+}
+} // namespace
+
+void run_send_entry_test() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  using send_entry = pqrs::local_datagram::impl::send_entry;
+
+  "send_entry"_test = [] {
+    // header only
+    {
+      send_entry e(send_entry::type::heartbeat, nullptr);
+      expect(flatten(e.make_buffers()) == std::vector<uint8_t>{0});
+      expect(e.size() == 1_ul);
+    }
+
+    // copy
+    {
+      std::vector<uint8_t> v{1, 2, 3};
+      send_entry e(send_entry::type::user_data, v, nullptr);
+      expect(flatten(e.make_buffers()) == std::vector<uint8_t>{1, 1, 2, 3});
+      expect(e.make_buffers()[1].data() != v.data());
+    }
+
+    // move
+    {
+      std::vector<uint8_t> v{1, 2, 3};
+      auto p = v.data();
+      send_entry e(send_entry::type::user_data, std::move(v), nullptr);
+      expect(flatten(e.make_buffers()) == std::vector<uint8_t>{1, 1, 2, 3});
+      expect(e.make_buffers()[1].data() == p);
+    }
+
+    // shared vector
+    {
+      auto v = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{1, 2, 3});
+      send_entry e(send_entry::type::user_data, v, nullptr);
+      expect(flatten(e.make_buffers()) == std::vector<uint8_t>{1, 1, 2, 3});
+      expect(e.make_buffers()[1].data() == v->data());
+      expect(v.use_count() == 2_l);
+    }
+
+    // caller-owned payload with release callback
+    {
+      bool released = false;
+      std::array<uint8_t, 3> payload{1, 2, 3};
+
+      {
+        auto owner = std::shared_ptr<const void>(nullptr, [&](auto&&) {
+          released = true;
+        });
+
+        send_entry e(send_entry::type::user_data, payload, owner, nullptr);
+        owner = nullptr;
+
+        expect(flatten(e.make_buffers()) == std::vector<uint8_t>{1, 1, 2, 3});
+        expect(e.make_buffers()[1].data() == payload.data());
+        expect(!released);
+      }
+
+      expect(released);
+    }
+
+    // bytes_transferred
+    {
+      send_entry e(send_entry::type::user_data, std::vector<uint8_t>{1, 2, 3}, nullptr);
+
+      e.add_bytes_transferred(2);
+      expect(flatten(e.make_buffers()) == std::vector<uint8_t>{2, 3});
+      expect(e.rest_bytes() == 2_ul);
+      expect(!e.transfer_complete());
+
+      e.add_bytes_transferred(2);
+      expect(flatten(e.make_buffers()).empty());
+      expect(e.rest_bytes() == 0_ul);
+      expect(e.transfer_complete());
+    }
+
+    // batch
+    {
+      std::vector<int> processed_values;
+
+      send_entry e(send_entry::type::batch, nullptr);
+      e.append_batch_message(std::vector<uint8_t>{1, 2}, [&] {
+        processed_values.push_back(1);
+      });
+      e.append_batch_message(std::vector<uint8_t>{}, nullptr);
+      e.append_batch_message(std::vector<uint8_t>{3}, [&] {
+        processed_values.push_back(3);
+      });
+
+      // (The length is stored in the host byte order.)
+      std::vector<uint8_t> expected{2};
+      for (const auto& message : {std::vector<uint8_t>{1, 2}, std::vector<uint8_t>{}, std::vector<uint8_t>{3}}) {
+        send_entry::batch_message_length_t length = message.size();
+        auto p = reinterpret_cast<const uint8_t*>(&length);
+        expected.insert(std::end(expected), p, p + sizeof(length));
+        expected.insert(std::end(expected), std::begin(message), std::end(message));
+      }
+
+      expect(flatten(e.make_buffers()) == expected);
+      expect(e.size() == expected.size());
+
+      e.get_processed()();
+      expect(processed_values == std::vector<int>{1, 3});
+    }
+  };
+}
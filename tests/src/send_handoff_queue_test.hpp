@@ -0,0 +1,142 @@
+#include "test.hpp"
+#include <boost/ut.hpp>
+#include <thread>
+
+void run_send_handoff_queue_test() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  using send_entry = pqrs::local_datagram::impl::send_entry;
+  using send_handoff_queue = pqrs::local_datagram::impl::send_handoff_queue;
+
+  auto make_entry = [](uint32_t value) {
+    std::vector<uint8_t> buffer(sizeof(value));
+    memcpy(buffer.data(), &value, sizeof(value));
+    return std::make_shared<send_entry>(send_entry::type::user_data,
+                                        buffer,
+                                        nullptr);
+  };
+
+  auto payload = [](auto&& entry) {
+    uint32_t value;
+    memcpy(&value, entry->make_buffers()[1].data(), sizeof(value));
+    return value;
+  };
+
+  "send_handoff_queue"_test = [&] {
+    std::vector<uint32_t> orphans;
+    send_handoff_queue queue([&](auto&& entry) {
+      orphans.push_back(payload(entry));
+    });
+
+    // Orphaned
+
+    queue.push(make_entry(1));
+    expect(orphans == std::vector<uint32_t>{1});
+    expect(queue.get_pending_count() == 0);
+
+    // Attached
+
+    int consumer = 0;
+    int wakeup_count = 0;
+    queue.attach(&consumer, [&] {
+      ++wakeup_count;
+    });
+
+    queue.push(make_entry(2));
+    queue.push(make_entry(3));
+    queue.push(make_entry(4));
+    expect(wakeup_count == 1);
+    expect(queue.get_pending_count() == 3);
+
+    std::vector<uint32_t> drained;
+    queue.drain([&](auto&& entry) {
+      drained.push_back(payload(entry));
+    });
+    expect(drained == std::vector<uint32_t>{2, 3, 4});
+    expect(queue.get_pending_count() == 0);
+
+    queue.push(make_entry(5));
+    expect(wakeup_count == 2);
+
+    // Suspended
+
+    int other_consumer = 0;
+    queue.suspend(&other_consumer);
+    queue.push(make_entry(6));
+    expect(wakeup_count == 2);
+
+    queue.suspend(&consumer);
+    queue.push(make_entry(7));
+    expect(wakeup_count == 2);
+    expect(queue.get_pending_count() == 3);
+
+    // Attach again
+
+    queue.attach(&consumer, [&] {
+      ++wakeup_count;
+    });
+    expect(wakeup_count == 3);
+
+    drained.clear();
+    queue.drain([&](auto&& entry) {
+      drained.push_back(payload(entry));
+    });
+    expect(drained == std::vector<uint32_t>{5, 6, 7});
+
+    // Detached
+
+    queue.suspend(&consumer);
+    queue.push(make_entry(8));
+    queue.detach();
+    expect(orphans == std::vector<uint32_t>{1, 8});
+    expect(queue.get_pending_count() == 0);
+  };
+
+  "send_handoff_queue multiple producers"_test = [&] {
+    constexpr uint32_t producer_count = 4;
+    constexpr uint32_t count = 10000;
+
+    send_handoff_queue queue([](auto&&) {});
+
+    std::atomic<bool> woken = false;
+    int consumer = 0;
+    queue.attach(&consumer, [&] {
+      woken = true;
+    });
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < producer_count; ++p) {
+      producers.emplace_back([&, p] {
+        for (uint32_t i = 0; i < count; ++i) {
+          queue.push(make_entry(p * count + i));
+        }
+      });
+    }
+
+    // The order of entries from each producer must be kept.
+
+    std::vector<uint32_t> next(producer_count, 0);
+    uint32_t total = 0;
+    bool ordered = true;
+    while (total < producer_count * count) {
+      queue.drain([&](auto&& entry) {
+        auto value = payload(entry);
+        auto p = value / count;
+        if (value % count != next[p]) {
+          ordered = false;
+        }
+        next[p] = value % count + 1;
+        ++total;
+      });
+    }
+
+    for (auto&& t : producers) {
+      t.join();
+    }
+
+    expect(ordered);
+    expect(woken == true);
+    expect(queue.get_pending_count() == 0);
+  };
+}
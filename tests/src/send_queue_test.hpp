@@ -0,0 +1,138 @@
+#include "test.hpp"
+#include <boost/ut.hpp>
+
+void run_send_queue_test() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  using send_entry = pqrs::local_datagram::impl::send_entry;
+
+  "send_queue"_test = [] {
+    auto endpoint1 = std::make_shared<asio::local::datagram_protocol::endpoint>("tmp/endpoint1.sock");
+    auto endpoint2 = std::make_shared<asio::local::datagram_protocol::endpoint>("tmp/endpoint2.sock");
+
+    auto make_entry = [](uint8_t value,
+                         std::shared_ptr<asio::local::datagram_protocol::endpoint> destination_endpoint) {
+      return std::make_shared<send_entry>(send_entry::type::user_data,
+                                          std::vector<uint8_t>{value},
+                                          destination_endpoint);
+    };
+
+    auto payload = [](auto&& entry) {
+      return *static_cast<const uint8_t*>(entry->make_buffers()[1].data());
+    };
+
+    auto get_ready_payloads = [&](auto&& queue, size_t max_count, auto&& now) {
+      std::vector<pqrs::not_null_shared_ptr_t<send_entry>> entries;
+      queue.get_ready_entries(max_count, now, entries);
+
+      std::vector<uint8_t> result;
+      for (const auto& e : entries) {
+        result.push_back(payload(e));
+      }
+      return result;
+    };
+
+    auto now = pqrs::local_datagram::impl::asio_helper::time_point::now();
+
+    // Round-robin
+
+    {
+      pqrs::local_datagram::impl::send_queue queue;
+
+      auto e1 = make_entry(1, endpoint1);
+      queue.push_back(e1);
+      queue.push_back(make_entry(2, endpoint1));
+      queue.push_back(make_entry(3, endpoint1));
+      queue.push_back(make_entry(4, endpoint2));
+
+      expect(queue.size() == 4_ul);
+      expect(queue.get_bytes() == 8_ul);
+
+      expect(get_ready_payloads(queue, 1, now) == std::vector<uint8_t>{1});
+      expect(get_ready_payloads(queue, 10, now) == std::vector<uint8_t>{1, 4, 2, 3});
+
+      // endpoint1 is moved to the end of the round-robin order.
+      queue.pop(*e1);
+      expect(queue.size() == 3_ul);
+      expect(queue.get_bytes() == 6_ul);
+      expect(get_ready_payloads(queue, 10, now) == std::vector<uint8_t>{4, 2, 3});
+    }
+
+    // Park
+
+    {
+      pqrs::local_datagram::impl::send_queue queue;
+
+      queue.push_back(make_entry(1, endpoint1));
+      queue.push_back(make_entry(2, endpoint2));
+
+      expect(!queue.get_unpark_time());
+
+      queue.park(endpoint1.get(), now + std::chrono::milliseconds(100));
+
+      expect(get_ready_payloads(queue, 10, now) == std::vector<uint8_t>{2});
+      expect(queue.get_unpark_time() == now + std::chrono::milliseconds(100));
+
+      // endpoint1 is unparked and moved to the end of the round-robin order.
+      expect(get_ready_payloads(queue, 10, now + std::chrono::milliseconds(100)) == std::vector<uint8_t>{2, 1});
+      expect(!queue.get_unpark_time());
+
+      // Parked destinations are unparked in the order of the unpark time.
+      queue.park(endpoint2.get(), now + std::chrono::milliseconds(300));
+      queue.park(endpoint1.get(), now + std::chrono::milliseconds(200));
+      expect(get_ready_payloads(queue, 10, now).empty());
+      expect(queue.get_unpark_time() == now + std::chrono::milliseconds(200));
+      expect(get_ready_payloads(queue, 10, now + std::chrono::milliseconds(200)) == std::vector<uint8_t>{1});
+      expect(queue.get_unpark_time() == now + std::chrono::milliseconds(300));
+
+      // Re-parking updates the unpark time.
+      queue.park(endpoint2.get(), now + std::chrono::milliseconds(250));
+      expect(queue.get_unpark_time() == now + std::chrono::milliseconds(250));
+
+      queue.unpark_all();
+      expect(!queue.get_unpark_time());
+      expect(get_ready_payloads(queue, 10, now) == std::vector<uint8_t>{1, 2});
+    }
+
+    // pop_oldest
+
+    {
+      pqrs::local_datagram::impl::send_queue queue;
+
+      auto e1 = make_entry(1, endpoint1);
+      queue.push_back(e1);
+      queue.push_back(make_entry(2, endpoint2));
+      queue.push_back(make_entry(3, endpoint1));
+
+      expect(payload(pqrs::not_null_shared_ptr_t<send_entry>(queue.pop_oldest(e1.get()))) == 2);
+      expect(payload(pqrs::not_null_shared_ptr_t<send_entry>(queue.pop_oldest(e1.get()))) == 3);
+      expect(queue.pop_oldest(e1.get()) == nullptr);
+      expect(queue.size() == 1_ul);
+
+      // The oldest entry is found after the front entry is popped.
+      queue.push_back(make_entry(4, endpoint2));
+      queue.push_back(make_entry(5, endpoint1));
+      queue.pop(*e1);
+      expect(payload(pqrs::not_null_shared_ptr_t<send_entry>(queue.pop_oldest(nullptr))) == 4);
+      expect(payload(pqrs::not_null_shared_ptr_t<send_entry>(queue.pop_oldest(nullptr))) == 5);
+      expect(queue.empty());
+      expect(get_ready_payloads(queue, 10, now).empty());
+    }
+
+    // No destination (client mode)
+
+    {
+      pqrs::local_datagram::impl::send_queue queue;
+
+      auto e1 = make_entry(1, nullptr);
+      queue.push_back(e1);
+      queue.push_back(make_entry(2, nullptr));
+
+      expect(get_ready_payloads(queue, 10, now) == std::vector<uint8_t>{1, 2});
+
+      queue.pop(*e1);
+      expect(get_ready_payloads(queue, 10, now) == std::vector<uint8_t>{2});
+    }
+  };
+}
@@ -326,4 +326,572 @@ void run_server_test() {
     dispatcher->terminate();
     dispatcher = nullptr;
   };
+
+  "local_datagram::server socket_file_watch"_test = [] {
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    {
+      std::atomic<size_t> bound_count = 0;
+      std::atomic<size_t> closed_count = 0;
+
+      auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      // Disable the polling check in order to test the watcher.
+      server->set_server_check_interval(std::nullopt);
+      server->set_socket_file_watch(true);
+      // A long interval in order to check that the server is bound again without waiting it.
+      server->set_reconnect_interval(std::chrono::milliseconds(5000));
+
+      server->bound.connect([&] {
+        ++bound_count;
+      });
+
+      server->closed.connect([&] {
+        ++closed_count;
+      });
+
+      server->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      expect(bound_count.load() == 1_ul);
+      expect(closed_count.load() == 0_ul);
+
+      // The watcher ignores other files.
+
+      {
+        std::ofstream(test_constants::server_socket_file_path.string() + ".other");
+        std::error_code error_code;
+        std::filesystem::remove(test_constants::server_socket_file_path.string() + ".other", error_code);
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      expect(closed_count.load() == 0_ul);
+
+      std::error_code error_code;
+      std::filesystem::remove(test_constants::server_socket_file_path, error_code);
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+#ifdef __linux__
+      expect(bound_count.load() == 2_ul);
+      expect(closed_count.load() == 1_ul);
+      expect(std::filesystem::exists(test_constants::server_socket_file_path));
+#endif
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::server received_batch"_test = [] {
+    std::cout << "TEST_CASE(local_datagram::server received_batch)" << std::endl;
+
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    {
+      size_t received_count = 0;
+      size_t received_batch_count = 0;
+      size_t received_batch_total = 0;
+      size_t max_batch_size = 0;
+
+      auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      server->set_receive_batch_size(16);
+
+      server->received.connect([&](auto&& buffer, auto&& sender_endpoint) {
+        ++received_count;
+      });
+
+      server->received_batch.connect([&](auto&& batch) {
+        ++received_batch_count;
+        received_batch_total += batch->size();
+        max_batch_size = std::max(max_batch_size, batch->size());
+      });
+
+      server->async_start();
+
+      // Wait for a while until server is prepared
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      auto client = std::make_unique<test_client>(dispatcher,
+                                                  std::nullopt,
+                                                  false);
+
+      expect(client->get_connected() == true);
+
+      for (int i = 0; i < 100; ++i) {
+        client->async_send();
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      // `received` is not emitted in batch mode.
+      expect(received_count == 0);
+      expect(received_batch_total == 100);
+      expect(received_batch_count > 0);
+      expect(max_batch_size <= 16);
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::server inline_received_handler"_test = [] {
+    std::cout << "TEST_CASE(local_datagram::server inline_received_handler)" << std::endl;
+
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    {
+      std::atomic<size_t> inline_received_count = 0;
+      std::atomic<size_t> dispatcher_thread_count = 0;
+      size_t received_count = 0;
+
+      auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      server->set_inline_received_handler([&](auto&& buffer, auto&& sender_endpoint) {
+        if (buffer.size() == 32 &&
+            buffer[0] == 10 &&
+            buffer[1] == 20 &&
+            buffer[2] == 30) {
+          ++inline_received_count;
+        }
+
+        if (dispatcher->dispatcher_thread()) {
+          ++dispatcher_thread_count;
+        }
+      });
+
+      server->received.connect([&](auto&& buffer, auto&& sender_endpoint) {
+        ++received_count;
+      });
+
+      server->async_start();
+
+      // Wait for a while until server is prepared
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      auto client = std::make_unique<test_client>(dispatcher,
+                                                  std::nullopt,
+                                                  false);
+
+      expect(client->get_connected() == true);
+
+      for (int i = 0; i < 10; ++i) {
+        client->async_send();
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+      expect(inline_received_count == 10);
+      expect(dispatcher_thread_count == 0);
+      expect(received_count == 0);
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::server async_receive"_test = [] {
+    std::cout << "TEST_CASE(local_datagram::server async_receive)" << std::endl;
+
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    {
+      // `io_ctx` has to outlive `server` since the waiting handler is aborted when `server` is destroyed.
+      asio::io_context io_ctx;
+      size_t received_count = 0;
+
+      auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      server->set_receive_queue_capacity(4);
+      server->received.connect([&](auto&& buffer, auto&& sender_endpoint) {
+        ++received_count;
+      });
+
+      // The client does not reconnect, so wait until the server is bound.
+      {
+        auto wait = pqrs::make_thread_wait();
+
+        server->bound.connect([wait] {
+          wait->notify();
+        });
+
+        server->async_start();
+
+        wait->wait_notice();
+      }
+
+      auto client = std::make_unique<pqrs::local_datagram::client>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::client_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      std::vector<uint8_t> client_received_values;
+      client->received.connect([&](auto&& buffer, auto&& sender_endpoint) {
+        client_received_values.insert(std::end(client_received_values), std::begin(*buffer), std::end(*buffer));
+      });
+      client->async_start();
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      // Data are kept in the socket buffer while the receive queue is full.
+      for (uint8_t i = 0; i < 100; ++i) {
+        client->async_send(std::vector<uint8_t>{i});
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      // Request/response in a coroutine which runs on the user's io_context.
+
+      std::vector<uint8_t> server_received_values;
+      std::vector<pqrs::local_datagram::send_status> statuses;
+
+      asio::co_spawn(
+          io_ctx,
+          [&]() -> asio::awaitable<void> {
+            for (int i = 0; i < 100; ++i) {
+              auto datagram = co_await server->async_receive(asio::use_awaitable);
+              server_received_values.insert(std::end(server_received_values),
+                                            std::begin(*(datagram.get_buffer())),
+                                            std::end(*(datagram.get_buffer())));
+
+              statuses.push_back(co_await server->async_send(*(datagram.get_buffer()),
+                                                             datagram.get_sender_endpoint(),
+                                                             asio::use_awaitable));
+            }
+          },
+          asio::detached);
+
+      io_ctx.run_for(std::chrono::seconds(5));
+
+      std::vector<uint8_t> expected;
+      for (uint8_t i = 0; i < 100; ++i) {
+        expected.push_back(i);
+      }
+      expect(server_received_values == expected);
+      expect(statuses == std::vector<pqrs::local_datagram::send_status>(100, pqrs::local_datagram::send_status::sent));
+      expect(received_count == 0);
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      expect(client_received_values == expected);
+
+      // The second `async_receive` is rejected while the first one is waiting.
+      // (Handlers without an associated executor are called in the system executor.)
+
+      std::atomic<int> first_error_value = 0;
+      std::atomic<int> second_error_value = 0;
+
+      server->async_receive([&](auto&& error_code, auto&& datagram) {
+        first_error_value = error_code.value();
+      });
+      server->async_receive([&](auto&& error_code, auto&& datagram) {
+        second_error_value = error_code.value();
+      });
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      expect(first_error_value.load() == 0_i);
+      expect(second_error_value.load() == static_cast<int>(asio::error::in_progress));
+
+      // The waiting handler is aborted when the server is destroyed.
+
+      server = nullptr;
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      expect(first_error_value.load() == static_cast<int>(asio::error::operation_aborted));
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::server stalled destination"_test = [] {
+    std::cout << "TEST_CASE(local_datagram::server stalled destination)" << std::endl;
+
+    for (const auto& send_batch_size : {std::optional<size_t>(), std::optional<size_t>(16)}) {
+      auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+      auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+      {
+        unlink(test_constants::client_socket_file_path.c_str());
+        unlink(test_constants::client_socket2_file_path.c_str());
+
+        asio::io_context io_ctx;
+
+        // A peer which never reads.
+        asio::local::datagram_protocol::socket stalled_socket(io_ctx);
+        stalled_socket.open();
+        stalled_socket.bind(asio::local::datagram_protocol::endpoint(test_constants::client_socket2_file_path));
+        stalled_socket.set_option(asio::socket_base::receive_buffer_size(4096));
+
+        asio::local::datagram_protocol::socket reader_socket(io_ctx);
+        reader_socket.open();
+        reader_socket.bind(asio::local::datagram_protocol::endpoint(test_constants::client_socket_file_path));
+        reader_socket.non_blocking(true);
+
+        auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                     test_constants::server_socket_file_path,
+                                                                     test_constants::server_buffer_size);
+        server->set_send_batch_size(send_batch_size);
+
+        {
+          auto wait = pqrs::make_thread_wait();
+
+          server->bound.connect([wait] {
+            wait->notify();
+          });
+
+          server->async_start();
+
+          wait->wait_notice();
+        }
+
+        auto stalled_endpoint = std::make_shared<asio::local::datagram_protocol::endpoint>(test_constants::client_socket2_file_path.string());
+        auto reader_endpoint = std::make_shared<asio::local::datagram_protocol::endpoint>(test_constants::client_socket_file_path.string());
+
+        std::vector<uint8_t> v(32);
+        for (int i = 0; i < 500; ++i) {
+          server->async_send(v, stalled_endpoint);
+        }
+
+        // Wait until the receive buffer of the stalled peer becomes full.
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        for (int i = 0; i < 10; ++i) {
+          server->async_send(v, reader_endpoint);
+        }
+
+        // The reader receives data while the stalled peer is full.
+
+        size_t reader_received_count = 0;
+        std::array<uint8_t, 64> buffer;
+        for (int i = 0; i < 200 && reader_received_count < 10; ++i) {
+          while (true) {
+            asio::error_code error_code;
+            reader_socket.receive(asio::buffer(buffer), 0, error_code);
+            if (error_code) {
+              break;
+            }
+            ++reader_received_count;
+          }
+
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        expect(reader_received_count == 10_ul);
+      }
+
+      dispatcher->terminate();
+      dispatcher = nullptr;
+    }
+  };
+
+  "local_datagram::server send_coalescing peer restart"_test = [] {
+    std::cout << "TEST_CASE(local_datagram::server send_coalescing peer restart)" << std::endl;
+
+    using send_entry = pqrs::local_datagram::impl::send_entry;
+
+    auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+    auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+    {
+      unlink(test_constants::client_socket_file_path.c_str());
+
+      auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                   test_constants::server_socket_file_path,
+                                                                   test_constants::server_buffer_size);
+      server->set_send_coalescing(std::chrono::milliseconds(10));
+
+      {
+        auto wait = pqrs::make_thread_wait();
+
+        server->bound.connect([wait] {
+          wait->notify();
+        });
+
+        server->async_start();
+
+        wait->wait_notice();
+      }
+
+      auto peer_endpoint = std::make_shared<asio::local::datagram_protocol::endpoint>(test_constants::client_socket_file_path.string());
+
+      // Raw sockets which act as clients in order to inspect datagrams.
+      asio::io_context io_ctx;
+
+      auto receive_types = [](auto&& socket) {
+        std::vector<uint8_t> result;
+        std::vector<uint8_t> buffer(test_constants::server_buffer_size);
+        while (true) {
+          asio::error_code error_code;
+          auto n = socket.receive(asio::buffer(buffer), 0, error_code);
+          if (error_code) {
+            break;
+          }
+          if (n > 0) {
+            result.push_back(buffer[0]);
+          }
+        }
+        return result;
+      };
+
+      // A new peer which accepts batches.
+
+      {
+        asio::local::datagram_protocol::socket peer_socket(io_ctx);
+        peer_socket.open();
+        peer_socket.bind(*peer_endpoint);
+        peer_socket.non_blocking(true);
+
+        std::array<uint8_t, 7> capabilities{static_cast<uint8_t>(send_entry::type::capabilities), 0};
+        uint32_t max_batch_size = test_constants::server_buffer_size;
+        memcpy(capabilities.data() + 2, &max_batch_size, sizeof(max_batch_size));
+        peer_socket.send_to(asio::buffer(capabilities),
+                            asio::local::datagram_protocol::endpoint(test_constants::server_socket_file_path));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        server->async_send(std::vector<uint8_t>{1}, peer_endpoint);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        expect(receive_types(peer_socket) == std::vector<uint8_t>{static_cast<uint8_t>(send_entry::type::batch)});
+      }
+
+      // The peer exits. (Sending to the peer fails.)
+
+      unlink(test_constants::client_socket_file_path.c_str());
+
+      server->async_send(std::vector<uint8_t>{2}, peer_endpoint);
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      // An old peer which does not send capabilities binds the same path.
+
+      {
+        asio::local::datagram_protocol::socket peer_socket(io_ctx);
+        peer_socket.open();
+        peer_socket.bind(*peer_endpoint);
+        peer_socket.non_blocking(true);
+
+        server->async_send(std::vector<uint8_t>{3}, peer_endpoint);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        expect(receive_types(peer_socket) == std::vector<uint8_t>{static_cast<uint8_t>(send_entry::type::user_data)});
+      }
+
+      unlink(test_constants::client_socket_file_path.c_str());
+    }
+
+    dispatcher->terminate();
+    dispatcher = nullptr;
+  };
+
+  "local_datagram::server no_buffer_space retry limits"_test = [] {
+    std::cout << "TEST_CASE(local_datagram::server no_buffer_space retry limits)" << std::endl;
+
+    unlink(test_constants::client_socket2_file_path.c_str());
+
+    asio::io_context io_ctx;
+
+    // A peer which never reads.
+    asio::local::datagram_protocol::socket stalled_socket(io_ctx);
+    stalled_socket.open();
+    stalled_socket.bind(asio::local::datagram_protocol::endpoint(test_constants::client_socket2_file_path));
+    stalled_socket.set_option(asio::socket_base::receive_buffer_size(4096));
+
+    auto stalled_endpoint = std::make_shared<asio::local::datagram_protocol::endpoint>(test_constants::client_socket2_file_path.string());
+
+    // Fill the receive buffer of the stalled peer.
+    {
+      asio::local::datagram_protocol::socket filler_socket(io_ctx);
+      filler_socket.open();
+      filler_socket.non_blocking(true);
+
+      std::array<uint8_t, 32> buffer{};
+      for (int i = 0; i < 10000; ++i) {
+        asio::error_code error_code;
+        filler_socket.send_to(asio::buffer(buffer), *stalled_endpoint, 0, error_code);
+        if (error_code) {
+          break;
+        }
+      }
+    }
+
+    // The retry interval is doubled from 1 ms up to 100 ms for each error.
+    // The entry is dropped at the error after `unsent_entry_retry_limit` retries.
+    struct retry_limit_case {
+      size_t unsent_entry_retry_limit;
+      std::chrono::milliseconds minimum_elapsed;
+      std::chrono::milliseconds maximum_elapsed;
+    };
+    for (const auto& c : {
+             // 1 + 2
+             retry_limit_case{2, std::chrono::milliseconds(3), std::chrono::milliseconds(3000)},
+             // 1 + 2 + 4 + 8 + 16 + 32
+             retry_limit_case{6, std::chrono::milliseconds(63), std::chrono::milliseconds(3000)},
+             // 1 + 2 + 4 + 8 + 16 + 32 + 64 + 100 * 5
+             // (4095 ms if the interval is not limited to 100 ms.)
+             retry_limit_case{12, std::chrono::milliseconds(627), std::chrono::milliseconds(4095)},
+         }) {
+      auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+      auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+      {
+        auto server = std::make_unique<pqrs::local_datagram::server>(dispatcher,
+                                                                     test_constants::server_socket_file_path,
+                                                                     test_constants::server_buffer_size);
+        server->set_no_buffer_space_retry_limits(c.unsent_entry_retry_limit,
+                                                 c.unsent_entry_retry_limit * 2);
+
+        std::atomic<size_t> error_occurred_count(0);
+        server->error_occurred.connect([&](auto&& error_code) {
+          ++error_occurred_count;
+        });
+
+        {
+          auto wait = pqrs::make_thread_wait();
+
+          server->bound.connect([wait] {
+            wait->notify();
+          });
+
+          server->async_start();
+
+          wait->wait_notice();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        auto future = server->async_send(std::vector<uint8_t>(32, '0'),
+                                         stalled_endpoint,
+                                         pqrs::local_datagram::use_future);
+        expect(future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+        expect(future.get() == pqrs::local_datagram::send_status::dropped_no_buffer_space);
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        expect(elapsed >= c.minimum_elapsed);
+        expect(elapsed < c.maximum_elapsed);
+
+        // `error_occurred` is emitted once for the dropped entry.
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        expect(error_occurred_count.load() == 1_ul);
+      }
+
+      dispatcher->terminate();
+      dispatcher = nullptr;
+    }
+  };
 }
@@ -0,0 +1,44 @@
+#include "test.hpp"
+#include <boost/ut.hpp>
+
+void run_socket_file_probe_test() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  using socket_file_probe = pqrs::local_datagram::impl::socket_file_probe;
+
+  "socket_file_probe"_test = [] {
+    std::filesystem::path path("tmp/socket_file_probe.sock");
+    unlink(path.c_str());
+
+    asio::io_context io_ctx;
+
+    auto socket = std::make_unique<asio::local::datagram_protocol::socket>(io_ctx);
+    socket->open();
+    socket->bind(asio::local::datagram_protocol::endpoint(path));
+
+    socket_file_probe probe(path);
+    expect(probe.probe() == socket_file_probe::status::reachable);
+
+    // The file is kept but no socket is bound.
+
+    socket = nullptr;
+    expect(probe.probe() == socket_file_probe::status::unreachable);
+
+    // Another socket is bound to the same path.
+
+    unlink(path.c_str());
+
+    socket = std::make_unique<asio::local::datagram_protocol::socket>(io_ctx);
+    socket->open();
+    socket->bind(asio::local::datagram_protocol::endpoint(path));
+
+    expect(probe.probe() == socket_file_probe::status::replaced);
+    expect(socket_file_probe(path).probe() == socket_file_probe::status::reachable);
+
+    // Removed
+
+    unlink(path.c_str());
+    expect(probe.probe() == socket_file_probe::status::missing);
+  };
+}
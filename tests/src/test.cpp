@@ -1,12 +1,28 @@
 #include "client_test.hpp"
+#include "endpoint_intern_table_test.hpp"
 #include "extra_peer_manager_test.hpp"
 #include "next_heartbeat_deadline_test.hpp"
+#include "next_heartbeat_deadline_wheel_test.hpp"
+#include "receive_buffer_pool_test.hpp"
+#include "send_entry_pool_test.hpp"
+#include "send_entry_test.hpp"
+#include "send_handoff_queue_test.hpp"
+#include "send_queue_test.hpp"
 #include "server_test.hpp"
+#include "socket_file_probe_test.hpp"
 
 int main() {
   run_client_test();
+  run_endpoint_intern_table_test();
   run_next_heartbeat_deadline_test();
+  run_next_heartbeat_deadline_wheel_test();
+  run_receive_buffer_pool_test();
+  run_send_entry_pool_test();
+  run_send_entry_test();
+  run_send_handoff_queue_test();
+  run_send_queue_test();
   run_server_test();
+  run_socket_file_probe_test();
   run_extra_peer_manager_test();
 
   return 0;